@@ -0,0 +1,115 @@
+// Measures the lexer's throughput on generated sources, once per scanning
+// implementation the CPU supports.
+//
+// usage: lexer_bench [megabytes] [iterations]
+
+#include "lexer/lexer.hpp"
+#include "lexer/scan.hpp"
+#include "utils/diagnostics.hpp"
+#include "utils/stream.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace {
+
+/// @brief Generates size bytes of Zap-like source, with long identifiers,
+/// indentation, comments and string literals. Documented makes every
+/// statement carry a long comment and message, to measure the long runs.
+std::string generate(size_t size, bool documented) {
+  static const char *const names[] = {
+      "result",      "index",        "studentAverage", "subjectCount",
+      "buffer_size", "remainingItems", "x",            "value2"};
+  static const char *const comments[] = {
+      "// Walks over every entry and sums up the grades of the student.",
+      "// TODO: handle the empty case",
+      "//"};
+  static const char *const docs[] = {
+      "// Adds the weighted grade of the current subject to the running "
+      "total, which is divided by the number of subjects at the end.",
+      "// The index can't overflow here: the caller already checked that "
+      "it is smaller than the length of the array it walks over."};
+  static const char *const messages[] = {
+      "\"Computing the weighted average of all subjects for the student "
+      "at the current index of the list...\"",
+      "\"Warning: the value is out of the expected range, the result is "
+      "clamped to the nearest valid grade.\""};
+  static const char *const strings[] = {
+      "\"Hello, world!\"", "\"The sum is: \"",
+      "\"line\\nwith \\\"escapes\\\" inside of it\"", "\"\""};
+
+  std::mt19937 rng(42);
+  auto pick = [&](const auto &list) {
+    return list[rng() % (sizeof(list) / sizeof(list[0]))];
+  };
+
+  std::string out;
+  out.reserve(size + 256);
+  size_t fn = 0;
+  while (out.size() < size) {
+    out += pick(comments);
+    out += "\nfun function";
+    out += std::to_string(fn++);
+    out += "(a: Int, b: Int) Int {\n";
+    for (int i = 0; i < 8; ++i) {
+      out += "    var ";
+      out += pick(names);
+      out += ": Int = a + b * ";
+      out += std::to_string(rng() % 1000);
+      out += ";\n        ";
+      out += documented ? pick(docs) : pick(comments);
+      out += "\n    println(";
+      out += documented ? pick(messages) : pick(strings);
+      out += ");\n";
+    }
+    out += "    return ";
+    out += pick(names);
+    out += ";\n}\n\n";
+  }
+  return out;
+}
+
+/// @brief Returns the best MB/s of iterations runs.
+double measure(const std::string &source, int iterations, size_t &tokens) {
+  double best = 0;
+  for (int i = 0; i < iterations; ++i) {
+    zap::DiagnosticEngine diag(source, "bench");
+    Lexer lexer(diag);
+
+    auto start = std::chrono::steady_clock::now();
+    tokens = lexer.tokenize(source).size();
+    std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - start;
+
+    best = std::max(best, double(source.size()) / 1e6 / time.count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  int iterations = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  for (bool documented : {false, true}) {
+    std::string source = generate(megabytes * 1000 * 1000, documented);
+    std::printf("%s input: %.1f MB, best of %d runs\n",
+                documented ? "documented" : "plain", source.size() / 1e6,
+                iterations);
+
+    for (const char *impl : {"scalar", "sse2", "avx2"}) {
+      if (!scan::useImplementation(impl)) {
+        std::printf("  %-8s unsupported\n", impl);
+        continue;
+      }
+      size_t tokens = 0;
+      double speed = measure(source, iterations, tokens);
+      std::printf("  %-8s %8.1f MB/s  (%zu tokens)\n", impl, speed, tokens);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+option(ZAPC_USE_LLD "Link executables in-process with LLD when it is available" ON)
+
+if(ZAPC_USE_LLD)
+    find_package(LLD CONFIG QUIET HINTS "${LLVM_DIR}/../lld")
+endif()
+
+if(ZAPC_USE_LLD AND LLD_FOUND)
+    # LLD is only the linker, the startup files, library directories and
+    # dynamic loader normally come from the C compiler driver. Ask it once
+    # at configure time instead of on every link.
+    set(ZAPC_LLD_OK TRUE)
+
+    foreach(startfile Scrt1.o crti.o crtbeginS.o crtendS.o crtn.o)
+        execute_process(
+            COMMAND ${CMAKE_C_COMPILER} -print-file-name=${startfile}
+            OUTPUT_VARIABLE startfile_path
+            OUTPUT_STRIP_TRAILING_WHITESPACE
+        )
+        string(MAKE_C_IDENTIFIER ${startfile} startfile_id)
+        string(TOUPPER ${startfile_id} startfile_id)
+        if(IS_ABSOLUTE "${startfile_path}" AND EXISTS "${startfile_path}")
+            list(APPEND ZAPC_LLD_DEFINITIONS ZAPC_LLD_${startfile_id}="${startfile_path}")
+        else()
+            message(STATUS "LLD: couldn't locate ${startfile}")
+            set(ZAPC_LLD_OK FALSE)
+        endif()
+    endforeach()
+
+    execute_process(
+        COMMAND ${CMAKE_C_COMPILER} -print-libgcc-file-name
+        OUTPUT_VARIABLE libgcc_path
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+    )
+
+    execute_process(
+        COMMAND ${CMAKE_C_COMPILER} "-###" -x c /dev/null -o /dev/null
+        ERROR_VARIABLE link_line
+    )
+    string(REGEX MATCH "-dynamic-linker[\" ]+([^\" ]+)" _ "${link_line}")
+    set(dynamic_linker "${CMAKE_MATCH_1}")
+    string(REGEX MATCHALL "\"?-L[^\" ]+" lib_dirs "${link_line}")
+    list(TRANSFORM lib_dirs REPLACE "^\"?-L" "")
+    list(REMOVE_DUPLICATES lib_dirs)
+    string(REPLACE ";" ":" lib_dirs "${lib_dirs}")
+
+    if(NOT dynamic_linker)
+        message(STATUS "LLD: couldn't determine the dynamic linker")
+        set(ZAPC_LLD_OK FALSE)
+    endif()
+
+    if(ZAPC_LLD_OK)
+        message(STATUS "Found LLD at ${LLD_DIR}, linking executables in-process")
+        list(APPEND ZAPC_LLD_DEFINITIONS
+            ZAPC_HAS_LLD
+            ZAPC_LLD_DYNAMIC_LINKER="${dynamic_linker}"
+            ZAPC_LLD_LIBGCC="${libgcc_path}"
+            ZAPC_LLD_LIB_DIRS="${lib_dirs}"
+        )
+        target_include_directories(zapc PRIVATE ${LLD_INCLUDE_DIRS})
+        target_link_libraries(zapc PRIVATE lldELF lldCommon)
+        target_compile_definitions(zapc PRIVATE ${ZAPC_LLD_DEFINITIONS})
+    else()
+        message(STATUS "LLD found but the C toolchain layout is unknown, linking through the system C compiler")
+    endif()
+else()
+    message(STATUS "LLD not used, linking through the system C compiler")
+endif()
@@ -15,15 +15,17 @@ NC='\033[0m' # No Color
 TOTAL=0
 PASSED=0
 
+# An optional fourth argument passes extra flags to the compiler.
 run_test() {
     local file=$1
     local expected_exit_code=$2
     local description=$3
+    local flags=$4
 
     ((TOTAL++))
     echo -n "Running $description ($file)... "
     
-    $ZAPC "$file" > /dev/null 2>&1
+    $ZAPC "$file" $flags > /dev/null 2>&1
     local exit_code=$?
     
     if [ $exit_code -eq $expected_exit_code ]; then
@@ -68,16 +70,18 @@ run_warning_test() {
 }
 
 # Runtime test: compile, run produced binary, check its exit code
+# An optional fourth argument passes extra flags to the compiler.
 run_runtime_test() {
     local file=$1
     local expected_exit_code=$2
     local description=$3
+    local flags=$4
 
     ((TOTAL++))
     echo -n "Running $description ($file)... "
 
     binfile="${file%.*}"
-    $ZAPC "$file" -o "$binfile" > /dev/null 2>&1
+    $ZAPC "$file" $flags -o "$binfile" > /dev/null 2>&1
     local exit_code=$?
     if [ $exit_code -ne 0 ]; then
         echo -e "${RED}FAIL${NC} (compile failed)"
@@ -101,6 +105,290 @@ run_runtime_test() {
     fi
 }
 
+# Error test: compile with the given flags, expect exit code 1 and the
+# pattern in stderr
+run_error_test() {
+    local file=$1
+    local pattern=$2
+    local description=$3
+    local flags=$4
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    tmpfile=$(mktemp)
+    $ZAPC "$file" $flags 2> "$tmpfile" > /dev/null
+    local exit_code=$?
+
+    if [ $exit_code -ne 1 ]; then
+        echo -e "${RED}FAIL${NC} (expected 1, got $exit_code)"
+    elif grep -qF "$pattern" "$tmpfile"; then
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    else
+        echo -e "${RED}FAIL${NC} ('$pattern' not reported)"
+    fi
+    rm -f "$tmpfile"
+}
+
+# Outline test: emit the outline and check it has the given line
+run_outline_test() {
+    local file=$1
+    local line=$2
+    local description=$3
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    tmpfile=$(mktemp)
+    $ZAPC "$file" -emit-outline -o "$tmpfile" > /dev/null 2>&1
+    local exit_code=$?
+
+    if [ $exit_code -ne 0 ]; then
+        echo -e "${RED}FAIL${NC} (compile failed)"
+    elif grep -qxF "$line" "$tmpfile"; then
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    else
+        echo -e "${RED}FAIL${NC} ('$line' not in the outline)"
+    fi
+    rm -f "$tmpfile"
+}
+
+# JIT test: run the file with `zapc run` and check the exit code of main
+run_jit_test() {
+    local file=$1
+    local expected_exit_code=$2
+    local description=$3
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    $ZAPC run "$file" > /dev/null 2>&1
+    local run_code=$?
+
+    if [ $run_code -eq $expected_exit_code ]; then
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    else
+        echo -e "${RED}FAIL${NC} (expected $expected_exit_code, got $run_code)"
+    fi
+}
+
+# Jobs test: compiling the sources with -j1 and -j4 has to give the same
+# binary and, when they fail, the same diagnostics in input order
+run_jobs_test() {
+    local description=$1
+    shift
+
+    ((TOTAL++))
+    echo -n "Running $description ($*)... "
+
+    local tmpdir=$(mktemp -d)
+    $ZAPC "$@" -j1 -o "$tmpdir/j1" > /dev/null 2> "$tmpdir/j1.err"
+    local code1=$?
+    $ZAPC "$@" -j4 -o "$tmpdir/j4" > /dev/null 2> "$tmpdir/j4.err"
+    local code4=$?
+
+    if [ $code1 -ne $code4 ]; then
+        echo -e "${RED}FAIL${NC} (exit codes $code1 and $code4 differ)"
+    elif ! cmp -s "$tmpdir/j1.err" "$tmpdir/j4.err"; then
+        echo -e "${RED}FAIL${NC} (diagnostics differ)"
+    elif [ $code1 -eq 0 ] && ! cmp -s "$tmpdir/j1" "$tmpdir/j4"; then
+        echo -e "${RED}FAIL${NC} (binaries differ)"
+    else
+        # Every failing file is reported, in the order of the inputs.
+        local order=$(grep -oF "$(printf '%s\n' "$@")" "$tmpdir/j1.err" | uniq)
+        local expected=$(for f in "$@"; do grep -q "$f" "$tmpdir/j1.err" && echo "$f"; done)
+        if [ "$order" == "$expected" ]; then
+            echo -e "${GREEN}PASS${NC}"
+            ((PASSED++))
+        else
+            echo -e "${RED}FAIL${NC} (diagnostics out of input order)"
+        fi
+    fi
+    rm -rf "$tmpdir"
+}
+
+# Cleanup test: when one of the sources fails, no object of the others may
+# be left behind, neither next to the sources nor in the temporary directory
+run_failed_cleanup_test() {
+    local description=$1
+    shift
+
+    ((TOTAL++))
+    echo -n "Running $description ($*)... "
+
+    local tmpdir=$(mktemp -d)
+    local outdir=$(mktemp -d)
+    TMPDIR="$tmpdir" $ZAPC "$@" -j4 -o "$outdir/a.out" > /dev/null 2>&1
+    local exit_code=$?
+    local leftovers=$(find "$tmpdir" "$outdir" -mindepth 1; for f in "$@"; do ls "${f%.*}.o" 2> /dev/null; done)
+
+    if [ $exit_code -ne 1 ]; then
+        echo -e "${RED}FAIL${NC} (expected 1, got $exit_code)"
+    elif [ -n "$leftovers" ]; then
+        echo -e "${RED}FAIL${NC} (left behind: $leftovers)"
+    else
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    fi
+    rm -rf "$tmpdir" "$outdir"
+}
+
+# Time report test: -ftime-report has to print every phase of the pipeline
+run_time_report_test() {
+    local file=$1
+    local description=$2
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    local tmpdir=$(mktemp -d)
+    $ZAPC "$file" -ftime-report -o "$tmpdir/a.out" 2> "$tmpdir/report" > /dev/null
+    local exit_code=$?
+
+    local missing=""
+    for phase in "zapc time report" "Read" "Lex and parse" "Bind" "IR generation" \
+                 "Optimization" "Emission" "Link" "Total"; do
+        grep -q "$phase" "$tmpdir/report" || missing="$missing '$phase'"
+    done
+
+    if [ $exit_code -ne 0 ]; then
+        echo -e "${RED}FAIL${NC} (compile failed)"
+    elif [ -n "$missing" ]; then
+        echo -e "${RED}FAIL${NC} (missing$missing)"
+    else
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    fi
+    rm -rf "$tmpdir"
+}
+
+# Time trace test: -ftime-trace=<file> has to write a valid JSON trace with
+# spans of the compiler phases
+run_time_trace_test() {
+    local file=$1
+    local description=$2
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    local tmpdir=$(mktemp -d)
+    # Spans shorter than the granularity are dropped, small files parse fast.
+    $ZAPC "$file" -ftime-trace="$tmpdir/trace.json" -ftime-trace-granularity=0 \
+        -o "$tmpdir/a.out" > /dev/null 2>&1
+    local exit_code=$?
+
+    if [ $exit_code -ne 0 ]; then
+        echo -e "${RED}FAIL${NC} (compile failed)"
+    elif [ ! -s "$tmpdir/trace.json" ]; then
+        echo -e "${RED}FAIL${NC} (trace not written)"
+    elif ! python3 -c '
+import json, sys
+events = json.load(open(sys.argv[1]))["traceEvents"]
+sys.exit(not any(e.get("name") == "Lex and parse" for e in events))
+' "$tmpdir/trace.json" 2> /dev/null; then
+        echo -e "${RED}FAIL${NC} (trace isn't valid JSON with the phases)"
+    else
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    fi
+    rm -rf "$tmpdir"
+}
+
+# Multi-file runtime test: compile several sources into one binary with the
+# given flags, run it and check its exit code
+run_multi_runtime_test() {
+    local expected_exit_code=$1
+    local description=$2
+    local flags=$3
+    shift 3
+
+    ((TOTAL++))
+    echo -n "Running $description ($*)... "
+
+    local binfile=$(mktemp)
+    $ZAPC "$@" $flags -o "$binfile" > /dev/null 2>&1
+    if [ $? -ne 0 ]; then
+        echo -e "${RED}FAIL${NC} (compile failed)"
+        rm -f "$binfile"
+        return
+    fi
+
+    "$binfile" > /dev/null 2>&1
+    local run_code=$?
+    rm -f "$binfile"
+
+    if [ $run_code -eq $expected_exit_code ]; then
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    else
+        echo -e "${RED}FAIL${NC} (expected $expected_exit_code, got $run_code)"
+    fi
+}
+
+# Cache hit test: compile twice into a fresh --cache-dir, the second compile
+# has to reuse the cached object, untouched, and still give a working binary
+run_cache_hit_test() {
+    local file=$1
+    local description=$2
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    local cachedir=$(mktemp -d)
+    local binfile="$cachedir/a.out"
+    $ZAPC "$file" --cache-dir "$cachedir" -o "$binfile" > /dev/null 2>&1
+    local entry=$(find "$cachedir" -name '*.o')
+    local inode=$(stat -c %i "$entry" 2> /dev/null)
+    rm -f "$binfile"
+
+    $ZAPC "$file" --cache-dir "$cachedir" -o "$binfile" > /dev/null 2>&1
+    local exit_code=$?
+    local entries=$(find "$cachedir" -name '*.o' | wc -l)
+
+    if [ $exit_code -ne 0 ] || [ ! -x "$binfile" ]; then
+        echo -e "${RED}FAIL${NC} (compile failed)"
+    elif [ -z "$entry" ] || [ $entries -ne 1 ] ||
+         [ "$(stat -c %i "$entry")" != "$inode" ]; then
+        echo -e "${RED}FAIL${NC} (cache missed)"
+    elif ! "$binfile" > /dev/null 2>&1; then
+        echo -e "${RED}FAIL${NC} (binary from the cache failed)"
+    else
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    fi
+    rm -rf "$cachedir"
+}
+
+# Cache miss test: compiling again with other flags, which change the
+# emitted code, has to add a second entry instead of reusing the first
+run_cache_miss_test() {
+    local file=$1
+    local flags=$2
+    local description=$3
+
+    ((TOTAL++))
+    echo -n "Running $description ($file)... "
+
+    local cachedir=$(mktemp -d)
+    $ZAPC "$file" --cache-dir "$cachedir" -o "$cachedir/a.out" > /dev/null 2>&1
+    $ZAPC "$file" $flags --cache-dir "$cachedir" -o "$cachedir/a.out" > /dev/null 2>&1
+    local exit_code=$?
+    local entries=$(find "$cachedir" -name '*.o' | wc -l)
+
+    if [ $exit_code -ne 0 ]; then
+        echo -e "${RED}FAIL${NC} (compile failed)"
+    elif [ $entries -ne 2 ]; then
+        echo -e "${RED}FAIL${NC} (expected 2 cache entries, got $entries)"
+    else
+        echo -e "${GREEN}PASS${NC}"
+        ((PASSED++))
+    fi
+    rm -rf "$cachedir"
+}
+
 # Warning + Runtime test: check for warning AND exit code
 run_warning_runtime_test() {
     local file=$1
@@ -151,9 +439,13 @@ run_runtime_test "tests/main_implicit.zap" 0 "Main implicit return type and impl
 
 # Lexer errors (exit code 1)
 run_test "tests/lexer_error.zap" 1 "Lexer error: Unterminated string"
+run_test "tests/lexer_error_hex.zap" 1 "Lexer error: Hex literal without digits"
+run_test "tests/lexer_error_binary.zap" 1 "Lexer error: Invalid digit in binary literal"
+run_test "tests/lexer_error_overflow.zap" 1 "Lexer error: Integer literal too big for 64 bits"
 
 # Syntax errors (exit code 1)
 run_test "tests/syntax_error.zap" 1 "Syntax error: Missing semicolons"
+run_test "tests/outline_unterminated.zap" 1 "Syntax error: Unterminated function body"
 
 # Semantic errors (exit code 1)
 run_test "tests/sema_error.zap" 1 "Semantic error: Undefined variable"
@@ -171,6 +463,8 @@ run_test "tests/logical_type_error.zap" 1 "Logical operators type check"
 run_runtime_test "tests/enum_test.zap" 1 "Enum test"
 run_runtime_test "tests/array_test.zap" 0 "Array declaration, initialization, and indexing"
 run_runtime_test "tests/array_const_size.zap" 0 "Array size as a constant"
+run_runtime_test "tests/const_fold.zap" 0 "Constant folding of expressions, constants and ifs"
+run_runtime_test "tests/number_literals.zap" 0 "Hex, binary, 64-bit unsigned and minimum Int literals"
 
 # If expression tests
 run_runtime_test "tests/if_expr.zap" 2 "If expression result"
@@ -185,6 +479,49 @@ run_runtime_test "tests/struct_array_test.zap" 0 "Arrays of structs"
 run_runtime_test "tests/struct_types_test.zap" 0 "Structs with diverse field types"
 run_runtime_test "tests/precedence_test.zap" 0 "Operator precedence (NOT vs Member access)"
 
+# Optimization level tests
+run_runtime_test "tests/if_advanced.zap" 0 "Advanced if expressions at -O2" "-O2"
+run_runtime_test "tests/struct_fn_test.zap" 0 "Structs as function parameters at -O3" "-O3"
+run_runtime_test "tests/array_test.zap" 0 "Arrays at -Os" "-Os"
+
+# Target selection tests
+run_runtime_test "tests/struct_fn_test.zap" 0 "Structs as function parameters at -march=native" "-march=native"
+run_error_test "tests/valid.zap" "is not a recognized processor" "Unknown -march CPU" "-march=notacpu"
+run_error_test "tests/valid.zap" "is not a recognized feature" "Unknown -mattr feature" "-mattr=+notafeature"
+
+# Link time optimization tests
+run_runtime_test "tests/struct_fn_test.zap" 0 "Structs as function parameters with -flto" "-O2 -flto"
+run_multi_runtime_test 0 "Calls into another unit with -flto" "-O2 -flto" tests/multi_main.zap tests/multi_scale.zap
+run_runtime_test "tests/if_advanced.zap" 0 "Advanced if expressions with -flto=thin" "-O2 -flto=thin"
+run_multi_runtime_test 0 "Calls into another unit with -flto=thin" "-O2 -flto=thin" tests/multi_main.zap tests/multi_scale.zap
+run_multi_runtime_test 0 "Calls into another unit with -flto=thin -j4" "-O2 -flto=thin -j4" tests/multi_main.zap tests/multi_scale.zap
+
+# Lazy body parsing: -emit-outline skips bodies, -fsyntax-only parses them
+# one at a time afterwards
+run_outline_test "tests/outline.zap" "18 fun add(a: Int, b: Int) Int" "Outline past braces in strings and chars"
+run_test "tests/outline.zap" 0 "Syntax check of skipped bodies" "-fsyntax-only"
+run_test "tests/outline_unterminated.zap" 1 "Outline of an unterminated body" "-emit-outline -o /dev/null"
+run_outline_test "tests/lazy_body_error.zap" "5 fun second() Int" "Outline ignores errors in bodies"
+run_error_test "tests/lazy_body_error.zap" "tests/lazy_body_error.zap:6:18" "Syntax error in a lazily parsed body" "-fsyntax-only"
+
+# Timing tests
+run_time_report_test "tests/struct_fn_test.zap" "Time report lists every phase"
+run_time_trace_test "tests/struct_fn_test.zap" "Time trace is valid JSON"
+
+# Object cache tests
+run_cache_hit_test "tests/struct_fn_test.zap" "Second compile reuses the cached object"
+run_cache_miss_test "tests/struct_fn_test.zap" "-O2" "Changing -O misses the cache"
+run_cache_miss_test "tests/struct_fn_test.zap" "-march=native" "Changing -march misses the cache"
+
+# Parallel compilation tests
+run_jobs_test "Same binary with -j1 and -j4" tests/multi_main.zap tests/multi_scale.zap
+run_jobs_test "Diagnostics in input order with -j1 and -j4" tests/break_outside.zap tests/multi_scale.zap tests/continue_outside.zap tests/logical_type_error.zap
+run_failed_cleanup_test "No objects left when one unit fails" tests/multi_main.zap tests/break_outside.zap tests/multi_scale.zap
+
+# JIT tests
+run_jit_test "tests/enum_test.zap" 1 "Enum test with zapc run"
+run_jit_test "tests/concat.zap" 0 "Concat literal strings with zapc run"
+
 echo "-------------------------------"
 echo "Results: $PASSED / $TOTAL passed"
 
@@ -1,17 +1,19 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "expr_node.hpp"
 #include "visitor.hpp"
-#include <memory>
-#include <vector>
 
 class ArrayLiteralNode : public ExpressionNode {
 public:
-  std::vector<std::unique_ptr<ExpressionNode>> elements_;
+  zap::ArenaList<ExpressionNode *> elements_;
 
-  ArrayLiteralNode() noexcept = default;
-  explicit ArrayLiteralNode(
-      std::vector<std::unique_ptr<ExpressionNode>> elements)
-      : elements_(std::move(elements)) {}
+  ArrayLiteralNode() noexcept : ExpressionNode(NodeKind::ArrayLiteral) {}
+  explicit ArrayLiteralNode(zap::ArenaList<ExpressionNode *> elements) noexcept
+      : ExpressionNode(NodeKind::ArrayLiteral), elements_(elements) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ArrayLiteral;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
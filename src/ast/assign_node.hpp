@@ -7,12 +7,16 @@
 
 class AssignNode : public StatementNode {
 public:
-  std::unique_ptr<ExpressionNode> target_;
-  std::unique_ptr<ExpressionNode> expr_;
-  AssignNode() noexcept = default;
+  ExpressionNode *target_ = nullptr;
+  ExpressionNode *expr_ = nullptr;
+  AssignNode() noexcept : StatementNode(NodeKind::Assign) {}
 
-  AssignNode(std::unique_ptr<ExpressionNode> target, std::unique_ptr<ExpressionNode> expr)
-      : target_(std::move(target)), expr_(std::move(expr)) {}
+  AssignNode(ExpressionNode *target, ExpressionNode *expr) noexcept
+      : StatementNode(NodeKind::Assign), target_(target), expr_(expr) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Assign;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
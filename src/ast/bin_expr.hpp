@@ -1,18 +1,20 @@
 #pragma once
 #include "expr_node.hpp"
+#include "operators.hpp"
 #include "visitor.hpp"
-#include <memory>
-#include <string>
 
 class BinExpr : public ExpressionNode {
 public:
-  std::unique_ptr<ExpressionNode> left_;
-  std::string op_;
-  std::unique_ptr<ExpressionNode> right_;
-  BinExpr() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  BinExpr(std::unique_ptr<ExpressionNode> left, std::string op,
-          std::unique_ptr<ExpressionNode> right)
-      : left_(std::move(left)), op_(op), right_(std::move(right)) {}
+  ExpressionNode *left_ = nullptr;
+  BinaryOp op_ = BinaryOp::Add;
+  ExpressionNode *right_ = nullptr;
+  BinExpr() noexcept : ExpressionNode(NodeKind::BinExpr) {}
+  BinExpr(ExpressionNode *left, BinaryOp op, ExpressionNode *right) noexcept
+      : ExpressionNode(NodeKind::BinExpr), left_(left), op_(op), right_(right) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::BinExpr;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
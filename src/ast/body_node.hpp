@@ -1,29 +1,18 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "expr_node.hpp"
 #include "visitor.hpp"
-#include <iostream>
-#include <memory>
-#include <vector>
 
 class BodyNode : public ExpressionNode {
 public:
-  std::vector<std::unique_ptr<Node>> statements;
-  std::unique_ptr<ExpressionNode> result;
+  zap::ArenaList<Node *> statements;
+  ExpressionNode *result = nullptr;
 
-  BodyNode() noexcept = default;
-  ~BodyNode() noexcept override = default;
+  BodyNode() noexcept : ExpressionNode(NodeKind::Body) {}
 
-  void addStatement(std::unique_ptr<Node> statement) {
-    if (statement) {
-      statements.push_back(std::move(statement));
-    } else {
-      std::cerr << "Cannot add a null statement to BodyNode" << std::endl;
-    }
-  }
-
-  void setResult(std::unique_ptr<ExpressionNode> res) {
-    result = std::move(res);
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Body;
   }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -1,10 +1,15 @@
 #pragma once
 #include "node.hpp"
+#include "statement_node.hpp"
 #include "visitor.hpp"
 
 class BreakNode : public StatementNode {
 public:
-  BreakNode() noexcept = default;
+  BreakNode() noexcept : StatementNode(NodeKind::Break) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Break;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
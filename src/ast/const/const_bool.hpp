@@ -4,9 +4,14 @@
 
 class ConstBool : public ExpressionNode {
 public:
-  bool value_;
-  ConstBool() noexcept = default;
-  ConstBool(bool value) noexcept : value_(value) {}
+  bool value_ = false;
+  ConstBool() noexcept : ExpressionNode(NodeKind::ConstBool) {}
+  ConstBool(bool value) noexcept
+      : ExpressionNode(NodeKind::ConstBool), value_(value) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstBool;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -1,11 +1,18 @@
 #pragma once
+#include "../expr_node.hpp"
 #include "../visitor.hpp"
+#include <string>
 
 class ConstChar : public ExpressionNode {
 public:
   std::string value_;
-  ConstChar() = default;
-  ConstChar(std::string v) : value_(std::move(v)) {}
+  ConstChar() : ExpressionNode(NodeKind::ConstChar) {}
+  ConstChar(std::string v)
+      : ExpressionNode(NodeKind::ConstChar), value_(std::move(v)) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstChar;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -1,11 +1,17 @@
 #pragma once
+#include "../expr_node.hpp"
 #include "../visitor.hpp"
 
 class ConstFloat : public ExpressionNode {
 public:
-  double value_;
-  ConstFloat() noexcept = default;
-  ConstFloat(double value) noexcept : value_(value) {}
+  double value_ = 0;
+  ConstFloat() noexcept : ExpressionNode(NodeKind::ConstFloat) {}
+  ConstFloat(double value) noexcept
+      : ExpressionNode(NodeKind::ConstFloat), value_(value) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstFloat;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -1,11 +1,17 @@
 #pragma once
+#include "../expr_node.hpp"
 #include "../visitor.hpp"
 
 class ConstId : public ExpressionNode {
 public:
-  std::string value_;
-  ConstId() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  ConstId(std::string value) : value_(value) {}
+  zap::Identifier value_;
+  ConstId() noexcept : ExpressionNode(NodeKind::ConstId) {}
+  ConstId(zap::Identifier value) noexcept
+      : ExpressionNode(NodeKind::ConstId), value_(value) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstId;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
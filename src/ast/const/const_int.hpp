@@ -1,13 +1,19 @@
 #pragma once
+#include "../expr_node.hpp"
 #include "../visitor.hpp"
+#include <cstdint>
 
 class ConstInt : public ExpressionNode {
 public:
-  int64_t value_;
-  std::string typeName_ = "i32";
-  ConstInt() = default;
-  ConstInt(int64_t value, std::string typeName = "i32")
-      : value_(value), typeName_(typeName) {}
+  /// @brief Literals are never negative, a minus is a unary expression.
+  uint64_t value_ = 0;
+  ConstInt() : ExpressionNode(NodeKind::ConstInt) {}
+  ConstInt(uint64_t value)
+      : ExpressionNode(NodeKind::ConstInt), value_(value) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstInt;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -1,11 +1,19 @@
 #pragma once
+#include "../expr_node.hpp"
 #include "../visitor.hpp"
+#include <string>
 
 class ConstString : public ExpressionNode {
 public:
   std::string value_;
-  ConstString() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  ConstString(std::string value) : value_(value) {}
+  ConstString() noexcept(std::is_nothrow_default_constructible<std::string>::value)
+      : ExpressionNode(NodeKind::ConstString) {}
+  ConstString(std::string value)
+      : ExpressionNode(NodeKind::ConstString), value_(value) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstString;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -7,15 +7,19 @@
 
 class ConstDecl : public StatementNode {
 public:
-  std::string name_;
-  std::unique_ptr<TypeNode> type_;
-  std::unique_ptr<ExpressionNode> initializer_;
+  zap::Identifier name_;
+  TypeNode *type_ = nullptr;
+  ExpressionNode *initializer_ = nullptr;
 
-  ConstDecl() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  ConstDecl(std::string name, std::unique_ptr<TypeNode> type,
-          std::unique_ptr<ExpressionNode> initializer)
-      : name_(name), type_(std::move(type)),
-        initializer_(std::move(initializer)) {}
+  ConstDecl() noexcept : StatementNode(NodeKind::ConstDecl) {}
+  ConstDecl(zap::Identifier name, TypeNode *type,
+            ExpressionNode *initializer) noexcept
+      : StatementNode(NodeKind::ConstDecl), name_(name), type_(type),
+        initializer_(initializer) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::ConstDecl;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
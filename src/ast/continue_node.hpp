@@ -4,7 +4,11 @@
 
 class ContinueNode : public StatementNode {
 public:
-  ContinueNode() noexcept = default;
+  ContinueNode() noexcept : StatementNode(NodeKind::Continue) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Continue;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -1,18 +1,21 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "node.hpp"
 #include "top_level.hpp"
 #include "visitor.hpp"
-#include <memory>
 #include <string>
-#include <vector>
 
 class EnumDecl : public TopLevel {
 public:
-  std::string name_;
-  std::vector<std::string> entries_;
+  zap::Identifier name_;
+  zap::ArenaList<zap::Identifier> entries_;
 
-  EnumDecl(const std::string &name, std::vector<std::string> entries)
-      : name_(name), entries_(std::move(entries)) {}
+  EnumDecl(zap::Identifier name, zap::ArenaList<zap::Identifier> entries) noexcept
+      : TopLevel(NodeKind::EnumDecl), name_(name), entries_(entries) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::EnumDecl;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -2,10 +2,15 @@
 #include "node.hpp"
 #include "visitor.hpp"
 
-class ExpressionNode : public virtual Node {
+class ExpressionNode : public Node {
 public:
-  virtual ~ExpressionNode() noexcept = default;
-  ExpressionNode() noexcept = default;
+  static bool classof(const Node *node) noexcept {
+    return node->kind >= NodeKind::FIRST_EXPRESSION &&
+           node->kind <= NodeKind::LAST_EXPRESSION;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+
+protected:
+  explicit ExpressionNode(NodeKind kind) noexcept : Node(kind) {}
+};
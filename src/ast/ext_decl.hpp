@@ -1,26 +1,29 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "parameter_node.hpp"
 #include "top_level.hpp"
 #include "type_node.hpp"
 #include "visitor.hpp"
-#include <memory>
-#include <vector>
 
 class ExtDecl : public TopLevel
 {
 public:
-    std::string name_;
-    std::vector<std::unique_ptr<ParameterNode>> params_;
-    std::unique_ptr<TypeNode> returnType_;
+    zap::Identifier name_;
+    zap::ArenaList<ParameterNode *> params_;
+    TypeNode *returnType_ = nullptr;
     bool isPublic_ = false;
 
-    ExtDecl() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
+    ExtDecl() noexcept : TopLevel(NodeKind::ExtDecl) {}
 
-    ExtDecl(const std::string &name,
-            std::vector<std::unique_ptr<ParameterNode>> params,
-            std::unique_ptr<TypeNode> returnType, bool isPublic = false)
-        : name_(name), params_(std::move(params)),
-          returnType_(std::move(returnType)), isPublic_(isPublic) {}
+    ExtDecl(zap::Identifier name, zap::ArenaList<ParameterNode *> params,
+            TypeNode *returnType, bool isPublic = false) noexcept
+        : TopLevel(NodeKind::ExtDecl), name_(name), params_(params),
+          returnType_(returnType), isPublic_(isPublic) {}
+
+    static bool classof(const Node *node) noexcept
+    {
+        return node->kind == NodeKind::ExtDecl;
+    }
 
     void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -1,18 +1,26 @@
 #pragma once
+#include "../utils/arena.hpp"
+#include "expr_node.hpp"
 #include "visitor.hpp"
 
 struct Argument {
-  std::string name;
-  std::unique_ptr<ExpressionNode> value;
+  zap::Identifier name;
+  ExpressionNode *value;
 
-  Argument(const std::string &argName, std::unique_ptr<ExpressionNode> argValue)
-      : name(argName), value(std::move(argValue)) {}
+  Argument(zap::Identifier argName, ExpressionNode *argValue) noexcept
+      : name(argName), value(argValue) {}
 };
 
-class FunCall : public ExpressionNode, public StatementNode {
+class FunCall : public ExpressionNode {
 public:
-  std::string funcName_;
-  std::vector<std::unique_ptr<Argument>> params_;
+  zap::Identifier funcName_;
+  zap::ArenaList<Argument> params_;
+
+  FunCall() noexcept : ExpressionNode(NodeKind::FunCall) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::FunCall;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
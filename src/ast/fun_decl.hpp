@@ -1,38 +1,46 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "body_node.hpp"
 #include "node.hpp"
 #include "parameter_node.hpp"
 #include "top_level.hpp"
 #include "type_node.hpp"
 #include "visitor.hpp"
-#include <iostream>
-#include <memory>
-#include <vector>
 
 class FunDecl : public TopLevel {
 public:
-  std::string name_;
-  std::vector<std::unique_ptr<TypeNode>> genericParams_;
-  std::vector<std::unique_ptr<ParameterNode>> params_;
-  std::unique_ptr<TypeNode> returnType_;
-  std::unique_ptr<BodyNode> body_;
-  std::unique_ptr<ExpressionNode> lambdaExpr_;
+  zap::Identifier name_;
+  zap::ArenaList<TypeNode *> genericParams_;
+  zap::ArenaList<ParameterNode *> params_;
+  TypeNode *returnType_ = nullptr;
+  BodyNode *body_ = nullptr;
+  /// @brief The braces around the body while it's skipped, see
+  /// Parser::BodyMode::Lazy.
+  SourceSpan skippedBody_;
+  ExpressionNode *lambdaExpr_ = nullptr;
   bool isExtern_ = false;
   bool isStatic_ = false;
   bool isPublic_ = false;
 
-  FunDecl() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
+  FunDecl() noexcept : TopLevel(NodeKind::FunDecl) {}
 
-  FunDecl(const std::string &name,
-          std::vector<std::unique_ptr<TypeNode>> genericParams,
-          std::vector<std::unique_ptr<ParameterNode>> params,
-          std::unique_ptr<TypeNode> returnType, std::unique_ptr<BodyNode> body,
-          std::unique_ptr<ExpressionNode> lambdaExpr, bool isExtern = false,
-          bool isStatic = false, bool isPublic = false)
-      : name_(name), genericParams_(std::move(genericParams)),
-        params_(std::move(params)), returnType_(std::move(returnType)),
-        body_(std::move(body)), lambdaExpr_(std::move(lambdaExpr)),
-        isExtern_(isExtern), isStatic_(isStatic), isPublic_(isPublic) {}
+  FunDecl(zap::Identifier name, zap::ArenaList<TypeNode *> genericParams,
+          zap::ArenaList<ParameterNode *> params, TypeNode *returnType,
+          BodyNode *body, ExpressionNode *lambdaExpr, bool isExtern = false,
+          bool isStatic = false, bool isPublic = false) noexcept
+      : TopLevel(NodeKind::FunDecl), name_(name), genericParams_(genericParams),
+        params_(params), returnType_(returnType), body_(body),
+        lambdaExpr_(lambdaExpr), isExtern_(isExtern), isStatic_(isStatic),
+        isPublic_(isPublic) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::FunDecl;
+  }
+
+  /// @brief Returns whether the body still has to be parsed.
+  bool isBodySkipped() const noexcept {
+    return !body_ && skippedBody_.length != 0;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -1,23 +1,24 @@
 #pragma once
 #include "body_node.hpp"
 #include "expr_node.hpp"
-#include "statement_node.hpp"
 #include "visitor.hpp"
-#include <memory>
 
-class IfNode : public ExpressionNode, public StatementNode {
+class IfNode : public ExpressionNode {
 public:
-  std::unique_ptr<ExpressionNode> condition_;
-  std::unique_ptr<BodyNode> thenBody_;
-  std::unique_ptr<BodyNode> elseBody_;
+  ExpressionNode *condition_ = nullptr;
+  BodyNode *thenBody_ = nullptr;
+  BodyNode *elseBody_ = nullptr;
 
-  IfNode() noexcept = default;
+  IfNode() noexcept : ExpressionNode(NodeKind::If) {}
 
-  IfNode(std::unique_ptr<ExpressionNode> condition,
-         std::unique_ptr<BodyNode> thenBody,
-         std::unique_ptr<BodyNode> elseBody = nullptr)
-      : condition_(std::move(condition)), thenBody_(std::move(thenBody)),
-        elseBody_(std::move(elseBody)) {}
+  IfNode(ExpressionNode *condition, BodyNode *thenBody,
+         BodyNode *elseBody = nullptr) noexcept
+      : ExpressionNode(NodeKind::If), condition_(condition),
+        thenBody_(thenBody), elseBody_(elseBody) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::If;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
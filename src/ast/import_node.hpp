@@ -2,18 +2,19 @@
 #include "node.hpp"
 #include "top_level.hpp"
 #include "visitor.hpp"
-#include <iostream>
-#include <memory>
 #include <string>
 #include <vector>
 class ImportNode : public TopLevel {
 public:
   std::vector<std::string> path;
 
-  ImportNode() noexcept = default;
-  ImportNode(const std::vector<std::string> &importPath) : path(importPath) {}
+  ImportNode() noexcept : TopLevel(NodeKind::Import) {}
+  ImportNode(const std::vector<std::string> &importPath)
+      : TopLevel(NodeKind::Import), path(importPath) {}
 
-  ~ImportNode() noexcept override = default;
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Import;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
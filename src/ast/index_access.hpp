@@ -1,16 +1,18 @@
 #pragma once
 #include "expr_node.hpp"
 #include "visitor.hpp"
-#include <memory>
 
 class IndexAccessNode : public ExpressionNode {
 public:
-  std::unique_ptr<ExpressionNode> left_;
-  std::unique_ptr<ExpressionNode> index_;
+  ExpressionNode *left_;
+  ExpressionNode *index_;
 
-  IndexAccessNode(std::unique_ptr<ExpressionNode> left,
-                   std::unique_ptr<ExpressionNode> index)
-      : left_(std::move(left)), index_(std::move(index)) {}
+  IndexAccessNode(ExpressionNode *left, ExpressionNode *index) noexcept
+      : ExpressionNode(NodeKind::IndexAccess), left_(left), index_(index) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::IndexAccess;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
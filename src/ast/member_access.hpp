@@ -1,16 +1,19 @@
 #pragma once
 #include "expr_node.hpp"
 #include "visitor.hpp"
-#include <memory>
 #include <string>
 
 class MemberAccessNode : public ExpressionNode {
 public:
-  std::unique_ptr<ExpressionNode> left_;
-  std::string member_;
+  ExpressionNode *left_;
+  zap::Identifier member_;
 
-  MemberAccessNode(std::unique_ptr<ExpressionNode> left, std::string member)
-      : left_(std::move(left)), member_(std::move(member)) {}
+  MemberAccessNode(ExpressionNode *left, zap::Identifier member) noexcept
+      : ExpressionNode(NodeKind::MemberAccess), left_(left), member_(member) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::MemberAccess;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
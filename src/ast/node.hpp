@@ -1,4 +1,5 @@
 #pragma once
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 
@@ -6,9 +7,84 @@
 
 struct Visitor;
 
+/// @brief The concrete class of a node, grouped so that the abstract
+/// classes cover a contiguous range.
+enum class NodeKind : uint8_t {
+  Root,
+  Parameter,
+  Type,
+
+  // TopLevel
+  FunDecl,
+  ExtDecl,
+  EnumDecl,
+  RecordDecl,
+  StructDecl,
+  Import,
+
+  // StatementNode
+  VarDecl,
+  ConstDecl,
+  Return,
+  While,
+  Break,
+  Continue,
+  Assign,
+
+  // ExpressionNode, if expressions and calls are used as statements too.
+  Body,
+  If,
+  FunCall,
+  BinExpr,
+  UnaryExpr,
+  MemberAccess,
+  IndexAccess,
+  ArrayLiteral,
+  StructLiteral,
+  ConstInt,
+  ConstFloat,
+  ConstString,
+  ConstChar,
+  ConstBool,
+  ConstId,
+
+  FIRST_TOP_LEVEL = FunDecl,
+  LAST_TOP_LEVEL = Import,
+  FIRST_STATEMENT = VarDecl,
+  LAST_STATEMENT = Assign,
+  FIRST_EXPRESSION = Body,
+  LAST_EXPRESSION = ConstId,
+};
+
+/// @brief Nodes live in the arena of their compilation unit, they are never
+/// deleted on their own, so the destructor isn't virtual.
 class Node {
 public:
+  const NodeKind kind;
   SourceSpan span;
-  virtual ~Node() noexcept = default;
   virtual void accept(Visitor &v) = 0;
+
+protected:
+  explicit Node(NodeKind kind) noexcept : kind(kind) {}
+  ~Node() noexcept = default;
 };
+
+/// @brief Returns whether node is a T, using T::classof.
+template <typename T> bool isa(const Node *node) noexcept {
+  return T::classof(node);
+}
+
+/// @brief Casts node to T, which it has to be.
+template <typename T> T *cast(Node *node) noexcept {
+  assert(isa<T>(node) && "cast to the wrong node kind");
+  return static_cast<T *>(node);
+}
+
+/// @brief Casts node to T, null if node is null or not a T.
+template <typename T> T *dyn_cast(Node *node) noexcept {
+  return node && isa<T>(node) ? static_cast<T *>(node) : nullptr;
+}
+
+template <typename T> const T *dyn_cast(const Node *node) noexcept {
+  return node && isa<T>(node) ? static_cast<const T *>(node) : nullptr;
+}
@@ -19,6 +19,7 @@
 #include "index_access.hpp"
 #include "member_access.hpp"
 #include "node.hpp"
+#include "operators.hpp"
 #include "parameter_node.hpp"
 #include "return_node.hpp"
 #include "root_node.hpp"
@@ -0,0 +1,97 @@
+#pragma once
+#include "../token/token.hpp"
+#include <cassert>
+#include <cstdint>
+
+/// @brief The operator of a binary expression.
+enum class BinaryOp : uint8_t {
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Mod,
+  Pow,
+  Concat,
+  Equal,
+  NotEqual,
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual,
+  And,
+  Or,
+};
+
+/// @brief The operator of a unary expression.
+enum class UnaryOp : uint8_t {
+  Negate,
+  Not,
+};
+
+/// @brief Returns the binary operator spelled by the token type, which has
+/// to be one.
+inline BinaryOp binaryOpFromToken(TokenType type) {
+  switch (type) {
+    case TokenType::PLUS: return BinaryOp::Add;
+    case TokenType::MINUS: return BinaryOp::Sub;
+    case TokenType::MULTIPLY: return BinaryOp::Mul;
+    case TokenType::DIVIDE: return BinaryOp::Div;
+    case TokenType::MODULO: return BinaryOp::Mod;
+    case TokenType::POW: return BinaryOp::Pow;
+    case TokenType::CONCAT: return BinaryOp::Concat;
+    case TokenType::EQUAL: return BinaryOp::Equal;
+    case TokenType::NOTEQUAL: return BinaryOp::NotEqual;
+    case TokenType::LESS: return BinaryOp::Less;
+    case TokenType::LESSEQUAL: return BinaryOp::LessEqual;
+    case TokenType::GREATER: return BinaryOp::Greater;
+    case TokenType::GREATEREQUAL: return BinaryOp::GreaterEqual;
+    case TokenType::AND: return BinaryOp::And;
+    case TokenType::OR: return BinaryOp::Or;
+    default:
+      assert(false && "token is not a binary operator");
+      return BinaryOp::Add;
+  }
+}
+
+/// @brief Returns the unary operator spelled by the token type, which has to
+/// be one.
+inline UnaryOp unaryOpFromToken(TokenType type) {
+  switch (type) {
+    case TokenType::MINUS: return UnaryOp::Negate;
+    case TokenType::NOT: return UnaryOp::Not;
+    default:
+      assert(false && "token is not a unary operator");
+      return UnaryOp::Negate;
+  }
+}
+
+/// @brief Returns how the operator is written, for diagnostics.
+inline const char *binaryOpToString(BinaryOp op) {
+  switch (op) {
+    case BinaryOp::Add: return "+";
+    case BinaryOp::Sub: return "-";
+    case BinaryOp::Mul: return "*";
+    case BinaryOp::Div: return "/";
+    case BinaryOp::Mod: return "%";
+    case BinaryOp::Pow: return "^";
+    case BinaryOp::Concat: return "~";
+    case BinaryOp::Equal: return "==";
+    case BinaryOp::NotEqual: return "!=";
+    case BinaryOp::Less: return "<";
+    case BinaryOp::LessEqual: return "<=";
+    case BinaryOp::Greater: return ">";
+    case BinaryOp::GreaterEqual: return ">=";
+    case BinaryOp::And: return "&&";
+    case BinaryOp::Or: return "||";
+  }
+  return "?";
+}
+
+/// @brief Returns how the operator is written, for diagnostics.
+inline const char *unaryOpToString(UnaryOp op) {
+  switch (op) {
+    case UnaryOp::Negate: return "-";
+    case UnaryOp::Not: return "!";
+  }
+  return "?";
+}
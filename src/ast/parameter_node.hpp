@@ -2,17 +2,18 @@
 #include "node.hpp"
 #include "type_node.hpp"
 #include "visitor.hpp"
-#include <iostream>
-#include <memory>
-#include <vector>
 
 class ParameterNode : public Node {
 public:
-  std::string name;
-  std::unique_ptr<TypeNode> type;
+  zap::Identifier name;
+  TypeNode *type;
 
-  ParameterNode(const std::string &name, std::unique_ptr<TypeNode> type)
-      : name(name), type(std::move(type)) {}
+  ParameterNode(zap::Identifier name, TypeNode *type) noexcept
+      : Node(NodeKind::Parameter), name(name), type(type) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Parameter;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -1,20 +1,23 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "node.hpp"
 #include "parameter_node.hpp"
 #include "top_level.hpp"
 #include "visitor.hpp"
-#include <memory>
 #include <string>
-#include <vector>
 
 class RecordDecl : public TopLevel {
 public:
-  std::string name_;
-  std::vector<std::unique_ptr<ParameterNode>> fields_;
+  zap::Identifier name_;
+  zap::ArenaList<ParameterNode *> fields_;
 
-  RecordDecl(const std::string &name,
-             std::vector<std::unique_ptr<ParameterNode>> fields)
-      : name_(name), fields_(std::move(fields)) {}
+  RecordDecl(zap::Identifier name,
+             zap::ArenaList<ParameterNode *> fields) noexcept
+      : TopLevel(NodeKind::RecordDecl), name_(name), fields_(fields) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::RecordDecl;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -2,19 +2,18 @@
 #include "expr_node.hpp"
 #include "statement_node.hpp"
 #include "visitor.hpp"
-#include <iostream>
-#include <memory>
-#include <vector>
 
 class ReturnNode : public StatementNode {
 public:
-  std::unique_ptr<ExpressionNode> returnValue;
+  ExpressionNode *returnValue = nullptr;
 
-  ReturnNode() noexcept = default;
-  ReturnNode(std::unique_ptr<ExpressionNode> value)
-      : returnValue(std::move(value)) {}
-      
-  ~ReturnNode() noexcept override = default;
+  ReturnNode() noexcept : StatementNode(NodeKind::Return) {}
+  ReturnNode(ExpressionNode *value) noexcept
+      : StatementNode(NodeKind::Return), returnValue(value) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Return;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
@@ -1,23 +1,16 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "node.hpp"
 #include "visitor.hpp"
-#include <iostream>
-#include <memory>
-#include <vector>
 class RootNode : public Node {
 public:
-  std::vector<std::unique_ptr<Node>> children;
+  zap::ArenaList<Node *> children;
 
-  RootNode() noexcept = default;
+  RootNode() noexcept : Node(NodeKind::Root) {}
 
-  ~RootNode() noexcept override = default;
-
-  void addChild(std::unique_ptr<Node> child) {
-    if (child) {
-      children.push_back(std::move(child));
-    } else {
-      std::cerr << "Cannot add a null child to RootNode" << std::endl;
-    }
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Root;
   }
+
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
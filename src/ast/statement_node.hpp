@@ -2,9 +2,15 @@
 #include "node.hpp"
 #include "visitor.hpp"
 
-class StatementNode : public virtual Node {
+class StatementNode : public Node {
 public:
-  virtual ~StatementNode() noexcept = default;
+  static bool classof(const Node *node) noexcept {
+    return node->kind >= NodeKind::FIRST_STATEMENT &&
+           node->kind <= NodeKind::LAST_STATEMENT;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+
+protected:
+  explicit StatementNode(NodeKind kind) noexcept : Node(kind) {}
+};
@@ -1,17 +1,21 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "top_level.hpp"
 #include "parameter_node.hpp"
-#include <memory>
 #include <string>
-#include <vector>
 
 class StructDeclarationNode : public TopLevel {
 public:
-  std::string name_;
-  std::vector<std::unique_ptr<ParameterNode>> fields_;
+  zap::Identifier name_;
+  zap::ArenaList<ParameterNode *> fields_;
 
-  StructDeclarationNode(std::string name, std::vector<std::unique_ptr<ParameterNode>> fields)
-      : name_(std::move(name)), fields_(std::move(fields)) {}
+  StructDeclarationNode(zap::Identifier name,
+                        zap::ArenaList<ParameterNode *> fields) noexcept
+      : TopLevel(NodeKind::StructDecl), name_(name), fields_(fields) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::StructDecl;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
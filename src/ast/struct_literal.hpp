@@ -1,25 +1,30 @@
 #pragma once
+#include "../utils/arena.hpp"
 #include "expr_node.hpp"
 #include "visitor.hpp"
-#include <memory>
 #include <string>
-#include <vector>
 
 struct StructFieldInit {
-  std::string name;
-  std::unique_ptr<ExpressionNode> value;
-  
-  StructFieldInit(std::string n, std::unique_ptr<ExpressionNode> v) 
-      : name(std::move(n)), value(std::move(v)) {}
+  zap::Identifier name;
+  ExpressionNode *value;
+
+  StructFieldInit(zap::Identifier n, ExpressionNode *v) noexcept
+      : name(n), value(v) {}
 };
 
 class StructLiteralNode : public ExpressionNode {
 public:
-  std::string type_name_;
-  std::vector<StructFieldInit> fields_;
+  zap::Identifier type_name_;
+  zap::ArenaList<StructFieldInit> fields_;
+
+  StructLiteralNode(zap::Identifier type_name,
+                    zap::ArenaList<StructFieldInit> fields) noexcept
+      : ExpressionNode(NodeKind::StructLiteral), type_name_(type_name),
+        fields_(fields) {}
 
-  StructLiteralNode(std::string type_name, std::vector<StructFieldInit> fields)
-      : type_name_(std::move(type_name)), fields_(std::move(fields)) {}
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::StructLiteral;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
 };
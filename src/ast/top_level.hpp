@@ -4,7 +4,13 @@
 
 class TopLevel : public Node {
 public:
-  virtual ~TopLevel() noexcept = default;
+  static bool classof(const Node *node) noexcept {
+    return node->kind >= NodeKind::FIRST_TOP_LEVEL &&
+           node->kind <= NodeKind::LAST_TOP_LEVEL;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+
+protected:
+  explicit TopLevel(NodeKind kind) noexcept : Node(kind) {}
+};
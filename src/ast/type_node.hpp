@@ -2,21 +2,25 @@
 #include "expr_node.hpp"
 #include "node.hpp"
 #include "visitor.hpp"
-#include <memory>
 #include <string>
 
 class TypeNode : public Node {
 public:
-  std::string typeName;
+  zap::Identifier typeName;
   bool isReference = false;
   bool isPointer = false;
   bool isArray = false;
   bool isVarArgs = false;
-  std::unique_ptr<ExpressionNode> arraySize; // nullptr for non-array types
-  std::unique_ptr<TypeNode> baseType; // For recursive types like arrays or pointers
+  ExpressionNode *arraySize = nullptr; // nullptr for non-array types
+  TypeNode *baseType = nullptr; // For recursive types like arrays or pointers
 
-  TypeNode() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  explicit TypeNode(const std::string &typeName_) : typeName(typeName_) {}
+  TypeNode() noexcept : Node(NodeKind::Type) {}
+  explicit TypeNode(zap::Identifier typeName_) noexcept
+      : Node(NodeKind::Type), typeName(typeName_) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::Type;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
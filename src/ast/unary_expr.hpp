@@ -1,15 +1,19 @@
 #pragma once
 #include "expr_node.hpp"
+#include "operators.hpp"
 #include "visitor.hpp"
-#include <memory>
 
 class UnaryExpr : public ExpressionNode {
 public:
-  std::string op_;
-  std::unique_ptr<ExpressionNode> expr_;
-  UnaryExpr() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  UnaryExpr(std::string op, std::unique_ptr<ExpressionNode> expr)
-      : op_(op), expr_(std::move(expr)) {}
+  UnaryOp op_ = UnaryOp::Negate;
+  ExpressionNode *expr_ = nullptr;
+  UnaryExpr() noexcept : ExpressionNode(NodeKind::UnaryExpr) {}
+  UnaryExpr(UnaryOp op, ExpressionNode *expr) noexcept
+      : ExpressionNode(NodeKind::UnaryExpr), op_(op), expr_(expr) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::UnaryExpr;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -7,16 +7,20 @@
 
 class VarDecl : public StatementNode {
 public:
-  std::string name_;
-  std::unique_ptr<TypeNode> type_;
-  std::unique_ptr<ExpressionNode> initializer_;
+  zap::Identifier name_;
+  TypeNode *type_ = nullptr;
+  ExpressionNode *initializer_ = nullptr;
   bool isGlobal_ = false;
 
-  VarDecl() noexcept(std::is_nothrow_default_constructible<std::string>::value) = default;
-  VarDecl(std::string name, std::unique_ptr<TypeNode> type,
-          std::unique_ptr<ExpressionNode> initializer)
-      : name_(name), type_(std::move(type)),
-        initializer_(std::move(initializer)) {}
+  VarDecl() noexcept : StatementNode(NodeKind::VarDecl) {}
+  VarDecl(zap::Identifier name, TypeNode *type,
+          ExpressionNode *initializer) noexcept
+      : StatementNode(NodeKind::VarDecl), name_(name), type_(type),
+        initializer_(initializer) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::VarDecl;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
@@ -3,16 +3,18 @@
 #include "expr_node.hpp"
 #include "statement_node.hpp"
 #include "visitor.hpp"
-#include <memory>
 
 class WhileNode : public StatementNode {
 public:
-  std::unique_ptr<ExpressionNode> condition_;
-  std::unique_ptr<BodyNode> body_;
-  WhileNode() noexcept = default;
-  WhileNode(std::unique_ptr<ExpressionNode> condition,
-            std::unique_ptr<BodyNode> body)
-      : condition_(std::move(condition)), body_(std::move(body)) {}
+  ExpressionNode *condition_ = nullptr;
+  BodyNode *body_ = nullptr;
+  WhileNode() noexcept : StatementNode(NodeKind::While) {}
+  WhileNode(ExpressionNode *condition, BodyNode *body) noexcept
+      : StatementNode(NodeKind::While), condition_(condition), body_(body) {}
+
+  static bool classof(const Node *node) noexcept {
+    return node->kind == NodeKind::While;
+  }
 
   void accept(Visitor &v) override { v.visit(*this); }
-};
\ No newline at end of file
+};
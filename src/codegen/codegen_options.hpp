@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace codegen
+{
+
+  /// @brief Optimization level selected with -O<level>.
+  enum class OptLevel : uint8_t
+  {
+    O0, ///< No optimization (default).
+    O1, ///< Light optimization.
+    O2, ///< Default optimization.
+    O3, ///< Aggressive optimization.
+    Os, ///< Optimize for size.
+    Oz, ///< Optimize aggressively for size.
+  };
+
+  /// @brief Options that control how LLVMCodeGen lowers and emits a module.
+  /// Kept free of LLVM types so the driver can fill it in without pulling
+  /// in LLVM headers.
+  struct CodeGenOptions
+  {
+    OptLevel optLevel = OptLevel::O0;
+    /// @brief Target CPU (-march/-mcpu), empty for generic and "native" for
+    /// the host CPU.
+    std::string cpu;
+    /// @brief Comma separated target features (-mattr), e.g. "+avx2,-fma".
+    std::string features;
+    /// @brief Shortest span in microseconds recorded by -ftime-trace,
+    /// including the threads of the ThinLTO backend.
+    unsigned timeTraceGranularity = 500;
+  };
+
+} // namespace codegen
@@ -0,0 +1,152 @@
+#include "jit.hpp"
+#include "target.hpp"
+#include <cstdint>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/TargetParser/SubtargetFeature.h>
+
+namespace codegen
+{
+
+  /// @brief Prints the error, if there is one.
+  /// @return False if there was an error.
+  static bool succeeded(llvm::Error err)
+  {
+    if (!err)
+      return true;
+    llvm::errs() << "JIT error: " << llvm::toString(std::move(err)) << "\n";
+    return false;
+  }
+
+  JITRunner::JITRunner(const CodeGenOptions &options) : options_(options) {}
+
+  JITRunner::~JITRunner() = default;
+
+  llvm::orc::LLLazyJIT *JITRunner::getJIT()
+  {
+    if (jit_)
+      return jit_.get();
+
+    initializeNativeTarget();
+
+    auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!jtmb)
+    {
+      succeeded(jtmb.takeError());
+      return nullptr;
+    }
+
+    // The code runs on this machine, so only an explicit -march/-mattr
+    // changes what the host detection picked.
+    std::string cpu, features;
+    resolveTarget(options_, cpu, features);
+    if (!options_.cpu.empty())
+    {
+      jtmb->setCPU(cpu);
+      jtmb->getFeatures() = llvm::SubtargetFeatures(features);
+    }
+    else if (!features.empty())
+    {
+      jtmb->addFeatures({features});
+    }
+    jtmb->setCodeGenOptLevel(toCodeGenLevel(options_.optLevel));
+
+    // LLJIT links every JITDylib against the symbols of the current
+    // process by default, which is where libc comes from.
+    auto jit = llvm::orc::LLLazyJITBuilder()
+                   .setJITTargetMachineBuilder(std::move(*jtmb))
+                   .create();
+    if (!jit)
+    {
+      succeeded(jit.takeError());
+      return nullptr;
+    }
+
+    jit_ = std::move(*jit);
+    return jit_.get();
+  }
+
+  bool JITRunner::addModule(std::unique_ptr<llvm::Module> module,
+                            std::unique_ptr<llvm::LLVMContext> ctx)
+  {
+    auto *jit = getJIT();
+    if (!jit)
+      return false;
+
+    return succeeded(jit->addLazyIRModule(llvm::orc::ThreadSafeModule(
+        std::move(module), llvm::orc::ThreadSafeContext(std::move(ctx)))));
+  }
+
+  bool JITRunner::addObjectFile(const std::string &path)
+  {
+    auto *jit = getJIT();
+    if (!jit)
+      return false;
+
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer)
+    {
+      llvm::errs() << path << ": " << buffer.getError().message() << "\n";
+      return false;
+    }
+    return succeeded(jit->addObjectFile(std::move(*buffer)));
+  }
+
+  bool JITRunner::addArchive(const std::string &path)
+  {
+    auto *jit = getJIT();
+    if (!jit)
+      return false;
+
+    auto generator = llvm::orc::StaticLibraryDefinitionGenerator::Load(
+        jit->getObjLinkingLayer(), path.c_str());
+    if (!generator)
+      return succeeded(generator.takeError());
+
+    jit->getMainJITDylib().addGenerator(std::move(*generator));
+    return true;
+  }
+
+  bool JITRunner::addBitcodeFile(const std::string &path)
+  {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer)
+    {
+      llvm::errs() << path << ": " << buffer.getError().message() << "\n";
+      return false;
+    }
+
+    auto ctx = std::make_unique<llvm::LLVMContext>();
+    auto module = llvm::parseBitcodeFile((*buffer)->getMemBufferRef(), *ctx);
+    if (!module)
+      return succeeded(module.takeError());
+
+    return addModule(std::move(*module), std::move(ctx));
+  }
+
+  bool JITRunner::runMain(int &exitCode)
+  {
+    auto *jit = getJIT();
+    if (!jit)
+      return false;
+
+    auto mainAddr = jit->lookup("main");
+    if (!mainAddr)
+      return succeeded(mainAddr.takeError());
+
+    if (!succeeded(jit->initialize(jit->getMainJITDylib())))
+      return false;
+
+    // main returns an Int (i64), the C runtime of a native executable would
+    // only keep the low bits as the exit status as well.
+    auto *mainFn = mainAddr->toPtr<int64_t (*)()>();
+    exitCode = static_cast<int>(mainFn());
+
+    return succeeded(jit->deinitialize(jit->getMainJITDylib()));
+  }
+
+} // namespace codegen
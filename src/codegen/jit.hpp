@@ -0,0 +1,50 @@
+#pragma once
+#include "codegen_options.hpp"
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <memory>
+#include <string>
+
+namespace codegen
+{
+
+  /// @brief Runs a program in-process with ORC's LLLazyJIT instead of
+  /// emitting and linking an executable. Functions are only compiled when
+  /// they are first called. Symbols that aren't part of the added modules
+  /// or objects are resolved from the zapc process (libc).
+  class JITRunner
+  {
+  public:
+    explicit JITRunner(const CodeGenOptions &options = {});
+    ~JITRunner();
+
+    /// @brief Adds a generated module, which has to live in ctx.
+    /// @return False if the module couldn't be added.
+    bool addModule(std::unique_ptr<llvm::Module> module,
+                   std::unique_ptr<llvm::LLVMContext> ctx);
+
+    /// @brief Adds an object file, e.g. the compiled stdlib.
+    bool addObjectFile(const std::string &path);
+
+    /// @brief Adds a static archive, members are loaded on demand.
+    bool addArchive(const std::string &path);
+
+    /// @brief Adds a bitcode file, compiled lazily like generated modules.
+    bool addBitcodeFile(const std::string &path);
+
+    /// @brief Runs the static initializers, main and the finalizers.
+    /// @param exitCode Receives the value returned by main.
+    /// @return False if main couldn't be found or run.
+    bool runMain(int &exitCode);
+
+  private:
+    CodeGenOptions options_;
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit_;
+
+    /// @brief Creates the JIT on first use.
+    /// @return Null (after printing the reason) if it couldn't be created.
+    llvm::orc::LLLazyJIT *getJIT();
+  };
+
+} // namespace codegen
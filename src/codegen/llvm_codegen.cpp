@@ -1,26 +1,35 @@
 #include "llvm_codegen.hpp"
+#include "target.hpp"
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
-#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
-#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/FileSystem.h>
-#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <llvm/Support/raw_ostream.h>
-#include <llvm/Target/TargetMachine.h>
-#include <llvm/Target/TargetOptions.h>
-#include <llvm/TargetParser/Host.h>
 #include <stdexcept>
 
 namespace codegen
 {
 
-  LLVMCodeGen::LLVMCodeGen() : builder_(ctx_), nextStringId_(0), evaluateAsAddr_(false)
+  LLVMCodeGen::LLVMCodeGen(const CodeGenOptions &options)
+      : LLVMCodeGen(std::make_unique<llvm::LLVMContext>(), options) {}
+
+  LLVMCodeGen::LLVMCodeGen(llvm::LLVMContext &ctx, const CodeGenOptions &options)
+      : LLVMCodeGen(nullptr, options, &ctx) {}
+
+  LLVMCodeGen::LLVMCodeGen(std::unique_ptr<llvm::LLVMContext> ownedCtx,
+                           const CodeGenOptions &options, llvm::LLVMContext *ctx)
+      : options_(options), ownedCtx_(std::move(ownedCtx)),
+        ctx_(ctx ? *ctx : *ownedCtx_), builder_(ctx_), nextStringId_(0),
+        evaluateAsAddr_(false)
   {
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
+    initializeNativeTarget();
+    resolveTarget(options_, targetCpu_, targetFeatures_);
   }
 
   llvm::Constant *LLVMCodeGen::getOrCreateGlobalString(const std::string &str,
@@ -57,23 +66,45 @@ namespace codegen
       module_->print(os, nullptr);
   }
 
-  bool LLVMCodeGen::emitObjectFile(const std::string &path)
+  std::unique_ptr<llvm::Module> LLVMCodeGen::takeModule()
+  {
+    return std::move(module_);
+  }
+
+  llvm::TargetMachine *LLVMCodeGen::getTargetMachine()
   {
-    auto targetTripleStr = llvm::sys::getDefaultTargetTriple();
-    llvm::Triple triple(targetTripleStr);
-    module_->setTargetTriple(triple);
-    std::string error;
-    const auto *target = llvm::TargetRegistry::lookupTarget(targetTripleStr, error);
-    if (!target)
+    if (!targetMachine_)
     {
-      llvm::errs() << "Target lookup failed: " << error << "\n";
-      return false;
+      targetMachine_ = createTargetMachine(options_);
+      if (!targetMachine_)
+        return nullptr;
+      configureModule(*module_, *targetMachine_);
     }
+    return targetMachine_.get();
+  }
+
+  bool LLVMCodeGen::optimize(PipelineKind kind)
+  {
+    if (options_.optLevel == OptLevel::O0)
+      return true;
 
-    llvm::TargetOptions opts;
-    auto *tm = target->createTargetMachine(triple, "generic", "", opts,
-                                           llvm::Reloc::PIC_);
-    module_->setDataLayout(tm->createDataLayout());
+    // The pass pipeline assumes valid IR, so never hand it a broken module.
+    if (llvm::verifyModule(*module_, &llvm::errs()))
+      return false;
+
+    auto *tm = getTargetMachine();
+    if (!tm)
+      return false;
+
+    optimizeModule(*module_, *tm, options_.optLevel, kind);
+    return true;
+  }
+
+  bool LLVMCodeGen::emitObjectFile(const std::string &path)
+  {
+    auto *tm = getTargetMachine();
+    if (!tm)
+      return false;
 
     std::error_code ec;
     llvm::raw_fd_ostream dest(path, ec, llvm::sys::fs::OF_None);
@@ -83,22 +114,40 @@ namespace codegen
       return false;
     }
 
-    llvm::legacy::PassManager pm;
-    if (tm->addPassesToEmitFile(pm, dest, nullptr,
-                                llvm::CodeGenFileType::ObjectFile))
-    {
-      llvm::errs() << "TargetMachine cannot emit object file\n";
+    bool ok = emitObject(*module_, *tm, dest);
+    dest.flush();
+    return ok;
+  }
+
+  bool LLVMCodeGen::emitObjectToBuffer(llvm::SmallVectorImpl<char> &buffer)
+  {
+    auto *tm = getTargetMachine();
+    if (!tm)
       return false;
-    }
 
-    // TODO: Improve handling of verifying the module.
-    bool is_broken = llvm::verifyModule(*module_, &llvm::errs());
+    llvm::raw_svector_ostream dest(buffer);
+    return emitObject(*module_, *tm, dest);
+  }
 
-    if (!is_broken)
-      pm.run(*module_);
-    dest.flush();
-    delete tm;
-    return !is_broken;
+  bool LLVMCodeGen::emitBitcodeToBuffer(llvm::SmallVectorImpl<char> &buffer)
+  {
+    // The triple and data layout have to be in the bitcode for the backend.
+    if (!getTargetMachine())
+      return false;
+
+    if (llvm::verifyModule(*module_, &llvm::errs()))
+      return false;
+
+    // The summary lets the thin link decide what to import from this module
+    // without loading its IR.
+    llvm::ProfileSummaryInfo psi(*module_);
+    llvm::ModuleSummaryIndex index =
+        llvm::buildModuleSummaryIndex(*module_, nullptr, &psi);
+
+    llvm::raw_svector_ostream dest(buffer);
+    llvm::WriteBitcodeToFile(*module_, dest,
+                             /*ShouldPreserveUseListOrder=*/false, &index);
+    return true;
   }
 
   llvm::Type *LLVMCodeGen::toLLVMType(const zir::Type &ty)
@@ -140,14 +189,14 @@ namespace codegen
     case zir::TypeKind::Record:
     {
       const auto &rt = static_cast<const zir::RecordType &>(ty);
-      auto it = structCache_.find(rt.getName());
+      auto it = structCache_.find(&rt);
       if (it != structCache_.end())
         return it->second;
 
       if (rt.getName() == "String")
       {
-        auto *structTy = llvm::StructType::create(ctx_, rt.getName());
-        structCache_[rt.getName()] = structTy;
+        auto *structTy = llvm::StructType::create(ctx_, rt.getName().str());
+        structCache_[&rt] = structTy;
         std::vector<llvm::Type *> fieldTypes;
         fieldTypes.push_back(llvm::PointerType::getUnqual(
             llvm::Type::getInt8Ty(ctx_)));
@@ -156,8 +205,8 @@ namespace codegen
         return structTy;
       }
 
-      auto *structTy = llvm::StructType::create(ctx_, rt.getName());
-      structCache_[rt.getName()] = structTy;
+      auto *structTy = llvm::StructType::create(ctx_, rt.getName().str());
+      structCache_[&rt] = structTy;
       std::vector<llvm::Type *> fieldTypes;
       for (const auto &f : rt.getFields())
         fieldTypes.push_back(toLLVMType(*f.type));
@@ -200,10 +249,10 @@ namespace codegen
     {
       auto *ft = buildFunctionType(*extFn->symbol);
       auto *f = llvm::Function::Create(ft, llvm::Function::ExternalLinkage,
-                                       extFn->symbol->name, *module_);
+                                       extFn->symbol->name.str(), *module_);
       size_t idx = 0;
       for (auto &arg : f->args())
-        arg.setName(extFn->symbol->parameters[idx++]->name);
+        arg.setName(extFn->symbol->parameters[idx++]->name.str());
 
       functionMap_[extFn->symbol->name] = f;
     }
@@ -212,10 +261,14 @@ namespace codegen
     {
       auto *ft = buildFunctionType(*fn->symbol);
       auto *f = llvm::Function::Create(ft, llvm::Function::ExternalLinkage,
-                                       fn->symbol->name, *module_);
+                                       fn->symbol->name.str(), *module_);
       size_t idx = 0;
       for (auto &arg : f->args())
-        arg.setName(fn->symbol->parameters[idx++]->name);
+        arg.setName(fn->symbol->parameters[idx++]->name.str());
+
+      f->addFnAttr("target-cpu", targetCpu_);
+      if (!targetFeatures_.empty())
+        f->addFnAttr("target-features", targetFeatures_);
 
       functionMap_[fn->symbol->name] = f;
     }
@@ -232,6 +285,8 @@ namespace codegen
 
   void LLVMCodeGen::visit(sema::BoundFunctionDeclaration &node)
   {
+    llvm::TimeTraceScope timeScope("Generate function",
+                                   node.symbol->name.str());
     auto *fn = functionMap_.at(node.symbol->name);
     currentFn_ = fn;
     localValues_.clear();
@@ -315,7 +370,7 @@ namespace codegen
 
       auto *gv = new llvm::GlobalVariable(*module_, ty, node.symbol->is_const,
                                           llvm::GlobalVariable::ExternalLinkage,
-                                          initializer, node.symbol->name);
+                                          initializer, node.symbol->name.str());
       globalValues_[node.symbol->name] = gv;
     }
   }
@@ -441,11 +496,12 @@ namespace codegen
       const auto &rt = static_cast<const zir::RecordType &>(*node.type);
       if (rt.getName() == "String")
       {
+        const std::string &text = node.string.str();
         std::string gname;
-        auto *ptrConst = getOrCreateGlobalString(node.value, gname);
+        auto *ptrConst = getOrCreateGlobalString(text, gname);
         auto *lenConst =
             llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx_),
-                                   static_cast<uint64_t>(node.value.size()));
+                                   static_cast<uint64_t>(text.size()));
 
         auto *structTy = static_cast<llvm::StructType *>(toLLVMType(*node.type));
         std::vector<llvm::Constant *> elems;
@@ -457,69 +513,17 @@ namespace codegen
     }
 
     auto *ty = toLLVMType(*node.type);
-    if (ty->isIntegerTy(1))
+    if (ty->isIntegerTy())
     {
-      lastValue_ = llvm::ConstantInt::get(ty, node.value == "true" ? 1 : 0);
+      // Bools and unsigned values are zero extended, the others sign
+      // extended, so the value always fits the type.
+      bool isSigned = node.type->getKind() != zir::TypeKind::Bool &&
+                      !node.type->isUnsigned();
+      lastValue_ = llvm::ConstantInt::get(ty, node.integer, isSigned);
     }
-    else if (ty->isIntegerTy(8))
+    else if (ty->isFloatingPointTy())
     {
-      int64_t code = 0;
-      if (!node.value.empty())
-      {
-        if (node.value.size() >= 2 && node.value[0] == '\\')
-        {
-          switch (node.value[1])
-          {
-          case 'n':
-            code = '\n';
-            break;
-          case 't':
-            code = '\t';
-            break;
-          case 'r':
-            code = '\r';
-            break;
-          case '\\':
-            code = '\\';
-            break;
-          case '\'':
-            code = '\'';
-            break;
-          case '0':
-            code = '\0';
-            break;
-          default:
-            code = static_cast<unsigned char>(node.value[1]);
-            break;
-          }
-        }
-        else
-        {
-          code = static_cast<unsigned char>(node.value[0]);
-        }
-      }
-      lastValue_ = llvm::ConstantInt::get(ty, code, /*isSigned=*/false);
-    }
-    else if (ty->isIntegerTy())
-    {
-      if (node.type->isUnsigned())
-      {
-        lastValue_ =
-            llvm::ConstantInt::get(ty, std::stoull(node.value), /*isSigned=*/false);
-      }
-      else
-      {
-        lastValue_ =
-            llvm::ConstantInt::get(ty, std::stoll(node.value), /*isSigned=*/true);
-      }
-    }
-    else if (ty->isFloatTy())
-    {
-      lastValue_ = llvm::ConstantFP::get(ty, std::stof(node.value));
-    }
-    else if (ty->isDoubleTy())
-    {
-      lastValue_ = llvm::ConstantFP::get(ty, std::stod(node.value));
+      lastValue_ = llvm::ConstantFP::get(ty, node.real);
     }
     else
     {
@@ -547,13 +551,13 @@ namespace codegen
     {
       auto *ty = toLLVMType(*node.symbol->type);
       lastValue_ = builder_.CreateLoad(ty, addr,
-                                       node.symbol->name);
+                                       node.symbol->name.str());
     }
   }
 
   void LLVMCodeGen::visit(sema::BoundBinaryExpression &node)
   {
-    if (node.op == "&&")
+    if (node.op == BinaryOp::And)
     {
       auto *rhsBB = llvm::BasicBlock::Create(ctx_, "and.rhs", currentFn_);
       auto *mergeBB = llvm::BasicBlock::Create(ctx_, "and.merge", currentFn_);
@@ -577,7 +581,7 @@ namespace codegen
       return;
     }
 
-    if (node.op == "||")
+    if (node.op == BinaryOp::Or)
     {
       auto *rhsBB = llvm::BasicBlock::Create(ctx_, "or.rhs", currentFn_);
       auto *mergeBB = llvm::BasicBlock::Create(ctx_, "or.merge", currentFn_);
@@ -609,48 +613,61 @@ namespace codegen
     bool isFP = lhs->getType()->isFloatingPointTy();
     bool isUnsigned = node.left->type->isUnsigned();
 
-    if (node.op == "+")
+    switch (node.op)
+    {
+    case BinaryOp::Add:
       lastValue_ =
           isFP ? builder_.CreateFAdd(lhs, rhs) : builder_.CreateAdd(lhs, rhs);
-    else if (node.op == "-")
+      break;
+    case BinaryOp::Sub:
       lastValue_ =
           isFP ? builder_.CreateFSub(lhs, rhs) : builder_.CreateSub(lhs, rhs);
-    else if (node.op == "*")
+      break;
+    case BinaryOp::Mul:
       lastValue_ =
           isFP ? builder_.CreateFMul(lhs, rhs) : builder_.CreateMul(lhs, rhs);
-    else if (node.op == "/")
+      break;
+    case BinaryOp::Div:
       lastValue_ =
           isFP ? builder_.CreateFDiv(lhs, rhs)
                   : (isUnsigned ? builder_.CreateUDiv(lhs, rhs)
                                 : builder_.CreateSDiv(lhs, rhs));
-    else if (node.op == "%")
+      break;
+    case BinaryOp::Mod:
       lastValue_ =
           isFP ? builder_.CreateFRem(lhs, rhs)
                   : (isUnsigned ? builder_.CreateURem(lhs, rhs)
                                 : builder_.CreateSRem(lhs, rhs));
-    else if (node.op == "==")
+      break;
+    case BinaryOp::Equal:
       lastValue_ = isFP ? builder_.CreateFCmpOEQ(lhs, rhs)
                            : builder_.CreateICmpEQ(lhs, rhs);
-    else if (node.op == "!=")
+      break;
+    case BinaryOp::NotEqual:
       lastValue_ = isFP ? builder_.CreateFCmpONE(lhs, rhs)
                            : builder_.CreateICmpNE(lhs, rhs);
-    else if (node.op == "<")
+      break;
+    case BinaryOp::Less:
       lastValue_ = isFP ? builder_.CreateFCmpOLT(lhs, rhs)
                            : (isUnsigned ? builder_.CreateICmpULT(lhs, rhs)
                                          : builder_.CreateICmpSLT(lhs, rhs));
-    else if (node.op == "<=")
+      break;
+    case BinaryOp::LessEqual:
       lastValue_ = isFP ? builder_.CreateFCmpOLE(lhs, rhs)
                            : (isUnsigned ? builder_.CreateICmpULE(lhs, rhs)
                                          : builder_.CreateICmpSLE(lhs, rhs));
-    else if (node.op == ">")
+      break;
+    case BinaryOp::Greater:
       lastValue_ = isFP ? builder_.CreateFCmpOGT(lhs, rhs)
                            : (isUnsigned ? builder_.CreateICmpUGT(lhs, rhs)
                                          : builder_.CreateICmpSGT(lhs, rhs));
-    else if (node.op == ">=")
+      break;
+    case BinaryOp::GreaterEqual:
       lastValue_ = isFP ? builder_.CreateFCmpOGE(lhs, rhs)
                            : (isUnsigned ? builder_.CreateICmpUGE(lhs, rhs)
                                          : builder_.CreateICmpSGE(lhs, rhs));
-    else if (node.op == "~")
+      break;
+    case BinaryOp::Concat:
     {
       auto *i8Ty = llvm::Type::getInt8Ty(ctx_);
       auto *i64Ty = llvm::Type::getInt64Ty(ctx_);
@@ -706,21 +723,26 @@ namespace codegen
       res = builder_.CreateInsertValue(res, call, {0});
       res = builder_.CreateInsertValue(res, sumLen, {1});
       lastValue_ = res;
+      break;
+    }
+    default:
+      break;
     }
   }
 
   void LLVMCodeGen::visit(sema::BoundUnaryExpression &node)
   {
     node.expr->accept(*this);
-    if (node.op == "-")
+    switch (node.op)
     {
+    case UnaryOp::Negate:
       lastValue_ = node.type->isFloatingPoint()
                        ? builder_.CreateFNeg(lastValue_)
                        : builder_.CreateNeg(lastValue_);
-    }
-    else if (node.op == "!")
-    {
+      break;
+    case UnaryOp::Not:
       lastValue_ = builder_.CreateNot(lastValue_);
+      break;
     }
   }
 
@@ -859,7 +881,7 @@ namespace codegen
       throw std::runtime_error("Field '" + node.member + "' not found in type '" + node.left->type->toString() + "'");
 
     llvm::StructType *structTy = static_cast<llvm::StructType *>(toLLVMType(*recordType));
-    llvm::Value *fieldAddr = builder_.CreateStructGEP(structTy, leftAddr, fieldIndex, node.member);
+    llvm::Value *fieldAddr = builder_.CreateStructGEP(structTy, leftAddr, fieldIndex, node.member.str());
 
     if (evaluateAsAddr_)
     {
@@ -867,7 +889,7 @@ namespace codegen
     }
     else
     {
-      lastValue_ = builder_.CreateLoad(toLLVMType(*node.type), fieldAddr, node.member);
+      lastValue_ = builder_.CreateLoad(toLLVMType(*node.type), fieldAddr, node.member.str());
     }
   }
 
@@ -1,12 +1,16 @@
 #pragma once
 #include "../sema/bound_nodes.hpp"
+#include "codegen_options.hpp"
+#include "target.hpp"
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
-#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 namespace codegen
 {
@@ -14,14 +18,37 @@ namespace codegen
   class LLVMCodeGen : public sema::BoundVisitor
   {
   public:
-    LLVMCodeGen();
+    explicit LLVMCodeGen(const CodeGenOptions &options = {});
+
+    /// @brief Generates into a context owned by the caller, e.g. one shared
+    /// by every module that gets linked together for LTO.
+    explicit LLVMCodeGen(llvm::LLVMContext &ctx,
+                         const CodeGenOptions &options = {});
 
     void generate(sema::BoundRootNode &root);
 
+    /// @brief Hands the generated module over to the caller, the code
+    /// generator can't be used for it afterwards.
+    std::unique_ptr<llvm::Module> takeModule();
+
+    /// @brief Runs the default optimization pipeline for the selected
+    /// optimization level over the generated module. Does nothing at -O0.
+    /// @param kind ThinLTOPreLink for modules that are emitted as bitcode.
+    /// @return False if the module is broken or no target is available.
+    bool optimize(PipelineKind kind = PipelineKind::PerModule);
+
     void printIR(llvm::raw_ostream&) const;
 
     bool emitObjectFile(const std::string &path);
 
+    /// @brief Emits the object file into memory instead of the filesystem.
+    bool emitObjectToBuffer(llvm::SmallVectorImpl<char> &buffer);
+
+    /// @brief Emits the module as bitcode with a ThinLTO summary, so it can
+    /// be optimized across modules at link time.
+    /// @return False if the module is broken or no target is available.
+    bool emitBitcodeToBuffer(llvm::SmallVectorImpl<char> &buffer);
+
     void visit(sema::BoundRootNode &node) override;
     void visit(sema::BoundFunctionDeclaration &node) override;
     void visit(sema::BoundExternalFunctionDeclaration &node) override;
@@ -48,7 +75,16 @@ namespace codegen
     void visit(sema::BoundCast &node) override;
 
   private:
-    llvm::LLVMContext ctx_;
+    LLVMCodeGen(std::unique_ptr<llvm::LLVMContext> ownedCtx,
+                const CodeGenOptions &options, llvm::LLVMContext *ctx = nullptr);
+
+    CodeGenOptions options_;
+    std::string targetCpu_;
+    std::string targetFeatures_;
+    std::unique_ptr<llvm::TargetMachine> targetMachine_;
+
+    std::unique_ptr<llvm::LLVMContext> ownedCtx_;
+    llvm::LLVMContext &ctx_;
     llvm::IRBuilder<> builder_;
     std::unique_ptr<llvm::Module> module_;
 
@@ -56,10 +92,10 @@ namespace codegen
     llvm::Value *lastValue_ = nullptr;
     bool evaluateAsAddr_ = false;
 
-    std::map<std::string, llvm::Value *> localValues_;
-    std::map<std::string, llvm::GlobalVariable *> globalValues_;
-    std::map<std::string, llvm::Function *> functionMap_;
-    std::map<std::string, llvm::StructType *> structCache_;
+    std::unordered_map<zap::Identifier, llvm::Value *> localValues_;
+    std::unordered_map<zap::Identifier, llvm::GlobalVariable *> globalValues_;
+    std::unordered_map<zap::Identifier, llvm::Function *> functionMap_;
+    std::unordered_map<const zir::Type *, llvm::StructType *> structCache_;
     
     int nextStringId_ = 0;
 
@@ -68,6 +104,10 @@ namespace codegen
 
     std::vector<std::pair<llvm::BasicBlock *, llvm::BasicBlock *>> loopBBStack_;
 
+    /// @brief Creates the target machine on first use and stamps the module
+    /// with its triple and data layout.
+    llvm::TargetMachine *getTargetMachine();
+
     llvm::Type *toLLVMType(const zir::Type &ty);
     llvm::FunctionType *buildFunctionType(const sema::FunctionSymbol &sym);
 
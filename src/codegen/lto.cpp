@@ -0,0 +1,231 @@
+#include "lto.hpp"
+#include "target.hpp"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/LTO/LTO.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Object/Archive.h>
+#include <llvm/Object/SymbolicFile.h>
+#include <llvm/Support/Caching.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/IPO/Internalize.h>
+
+namespace codegen
+{
+
+  LTOCodeGen::LTOCodeGen(const CodeGenOptions &options)
+      : options_(options),
+        merged_(std::make_unique<llvm::Module>("zap_lto_module", ctx_))
+  {
+    preserved_.insert("main");
+  }
+
+  bool LTOCodeGen::addModule(std::unique_ptr<llvm::Module> module)
+  {
+    // Linker::linkModules returns true on error.
+    return !llvm::Linker::linkModules(*merged_, std::move(module));
+  }
+
+  void LTOCodeGen::preserveSymbol(const std::string &name)
+  {
+    preserved_.insert(name);
+  }
+
+  bool LTOCodeGen::emitObjectToBuffer(llvm::SmallVectorImpl<char> &buffer)
+  {
+    auto tm = createTargetMachine(options_);
+    if (!tm)
+      return false;
+    configureModule(*merged_, *tm);
+
+    if (llvm::verifyModule(*merged_, &llvm::errs()))
+      return false;
+
+    // Only main and the ext declared symbols can be referenced from outside
+    // the program, everything else may be inlined, specialized or dropped.
+    llvm::internalizeModule(*merged_, [this](const llvm::GlobalValue &gv)
+                            { return preserved_.count(gv.getName().str()) != 0; });
+
+    optimizeModule(*merged_, *tm, options_.optLevel, PipelineKind::FullLTO);
+
+    llvm::raw_svector_ostream dest(buffer);
+    return emitObject(*merged_, *tm, dest);
+  }
+
+  ThinLTOCodeGen::ThinLTOCodeGen(const CodeGenOptions &options, unsigned jobs)
+      : options_(options), jobs_(jobs)
+  {
+    preserved_.insert("main");
+  }
+
+  void ThinLTOCodeGen::addBitcode(std::unique_ptr<llvm::MemoryBuffer> buffer)
+  {
+    buffers_.push_back(std::move(buffer));
+  }
+
+  void ThinLTOCodeGen::preserveSymbol(const std::string &name)
+  {
+    preserved_.insert(name);
+  }
+
+  static void collectUndefined(llvm::object::SymbolicFile &file,
+                               std::set<std::string> &names)
+  {
+    for (const auto &sym : file.symbols())
+    {
+      auto flags = sym.getFlags();
+      if (!flags || !(*flags & llvm::object::BasicSymbolRef::SF_Undefined))
+      {
+        llvm::consumeError(flags.takeError());
+        continue;
+      }
+      std::string name;
+      llvm::raw_string_ostream os(name);
+      if (llvm::Error err = sym.printName(os))
+      {
+        llvm::consumeError(std::move(err));
+        continue;
+      }
+      names.insert(std::move(name));
+    }
+  }
+
+  bool ThinLTOCodeGen::preserveReferencedSymbols(const std::string &path)
+  {
+    auto binary = llvm::object::createBinary(path);
+    if (!binary)
+    {
+      llvm::errs() << path << ": " << llvm::toString(binary.takeError())
+                   << "\n";
+      return false;
+    }
+
+    llvm::object::Binary *bin = binary->getBinary();
+    if (auto *file = llvm::dyn_cast<llvm::object::SymbolicFile>(bin))
+    {
+      collectUndefined(*file, preserved_);
+      return true;
+    }
+
+    auto *archive = llvm::dyn_cast<llvm::object::Archive>(bin);
+    if (!archive)
+      return true;
+
+    llvm::Error err = llvm::Error::success();
+    for (const auto &child : archive->children(err))
+    {
+      auto member = child.getAsBinary();
+      if (!member)
+      {
+        llvm::consumeError(member.takeError());
+        continue;
+      }
+      if (auto *file = llvm::dyn_cast<llvm::object::SymbolicFile>(member->get()))
+        collectUndefined(*file, preserved_);
+    }
+    if (err)
+    {
+      llvm::errs() << path << ": " << llvm::toString(std::move(err)) << "\n";
+      return false;
+    }
+    return true;
+  }
+
+  bool ThinLTOCodeGen::run(std::vector<llvm::SmallVector<char, 0>> &objects)
+  {
+    initializeNativeTarget();
+
+    std::string cpu, features;
+    resolveTarget(options_, cpu, features);
+
+    llvm::lto::Config conf;
+    conf.CPU = cpu;
+    for (llvm::StringRef feature : llvm::split(features, ','))
+      if (!feature.empty())
+        conf.MAttrs.push_back(feature.str());
+    conf.RelocModel = llvm::Reloc::PIC_;
+    conf.TimeTraceEnabled = llvm::timeTraceProfilerEnabled();
+    conf.TimeTraceGranularity = options_.timeTraceGranularity;
+    conf.CGOptLevel = toCodeGenLevel(options_.optLevel);
+    // The LTO pipelines have no size levels, -Os and -Oz build -O2 ones.
+    switch (options_.optLevel)
+    {
+    case OptLevel::O0:
+      conf.OptLevel = 0;
+      break;
+    case OptLevel::O1:
+      conf.OptLevel = 1;
+      break;
+    case OptLevel::O3:
+      conf.OptLevel = 3;
+      break;
+    default:
+      conf.OptLevel = 2;
+      break;
+    }
+
+    llvm::lto::LTO lto(std::move(conf),
+                       llvm::lto::createInProcessThinBackend(
+                           llvm::heavyweight_hardware_concurrency(jobs_)));
+
+    // The symbol resolution a linker would do: the first definition of a
+    // symbol prevails, and only preserved symbols are visible to the
+    // native objects linked afterwards.
+    std::set<std::string> defined;
+    for (const auto &buffer : buffers_)
+    {
+      auto input = llvm::lto::InputFile::create(buffer->getMemBufferRef());
+      if (!input)
+      {
+        llvm::errs() << buffer->getBufferIdentifier() << ": "
+                     << llvm::toString(input.takeError()) << "\n";
+        return false;
+      }
+
+      std::vector<llvm::lto::SymbolResolution> resolutions;
+      for (const auto &sym : (*input)->symbols())
+      {
+        llvm::lto::SymbolResolution res;
+        if (!sym.isUndefined())
+        {
+          std::string name = sym.getName().str();
+          res.Prevailing = defined.insert(name).second;
+          res.FinalDefinitionInLinkageUnit = res.Prevailing;
+          res.VisibleToRegularObj = preserved_.count(name) != 0;
+        }
+        resolutions.push_back(res);
+      }
+
+      if (llvm::Error err = lto.add(std::move(*input), resolutions))
+      {
+        llvm::errs() << buffer->getBufferIdentifier() << ": "
+                     << llvm::toString(std::move(err)) << "\n";
+        return false;
+      }
+    }
+
+    objects.clear();
+    objects.resize(lto.getMaxTasks());
+    auto addStream = [&objects](unsigned task, const llvm::Twine &)
+        -> llvm::Expected<std::unique_ptr<llvm::CachedFileStream>>
+    {
+      return std::make_unique<llvm::CachedFileStream>(
+          std::make_unique<llvm::raw_svector_ostream>(objects[task]));
+    };
+
+    if (llvm::Error err = lto.run(addStream))
+    {
+      llvm::errs() << "ThinLTO failed: " << llvm::toString(std::move(err))
+                   << "\n";
+      return false;
+    }
+
+    // Tasks of partitions without any code don't produce an object.
+    llvm::erase_if(objects, [](const llvm::SmallVector<char, 0> &obj)
+                   { return obj.empty(); });
+    return true;
+  }
+
+} // namespace codegen
@@ -0,0 +1,82 @@
+#pragma once
+#include "codegen_options.hpp"
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace codegen
+{
+
+  /// @brief Whole-program (full LTO) code generator. The modules of every
+  /// translation unit are generated into one shared context, linked into a
+  /// single module, internalized, optimized with the LTO pipeline and
+  /// emitted as one object.
+  class LTOCodeGen
+  {
+  public:
+    explicit LTOCodeGen(const CodeGenOptions &options = {});
+
+    /// @brief Context every added module has to be generated in.
+    llvm::LLVMContext &getContext() { return ctx_; }
+
+    /// @brief Links a translation unit into the merged module.
+    /// @return False if linking failed.
+    bool addModule(std::unique_ptr<llvm::Module> module);
+
+    /// @brief Keeps a symbol externally visible when internalizing, main is
+    /// always kept.
+    void preserveSymbol(const std::string &name);
+
+    /// @brief Internalizes, optimizes and emits the merged module.
+    /// @return False if the module is broken or can't be emitted.
+    bool emitObjectToBuffer(llvm::SmallVectorImpl<char> &buffer);
+
+  private:
+    CodeGenOptions options_;
+    llvm::LLVMContext ctx_;
+    std::unique_ptr<llvm::Module> merged_;
+    std::set<std::string> preserved_;
+  };
+
+  /// @brief ThinLTO backend for bitcode modules that carry a summary. The
+  /// thin link only reads the summaries to decide what gets imported and
+  /// internalized, every module is then optimized and compiled on its own
+  /// thread into a separate object. Bitcode without a summary is merged
+  /// into a regular LTO partition.
+  class ThinLTOCodeGen
+  {
+  public:
+    /// @param jobs Backend threads, 0 for one per physical core.
+    explicit ThinLTOCodeGen(const CodeGenOptions &options = {},
+                            unsigned jobs = 0);
+
+    /// @brief Adds a bitcode module.
+    void addBitcode(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+    /// @brief Keeps a symbol externally visible when internalizing, main is
+    /// always kept.
+    void preserveSymbol(const std::string &name);
+
+    /// @brief Keeps every symbol the native object or archive at path
+    /// references visible, they are only resolved by the final link.
+    /// @return False if the file couldn't be read.
+    bool preserveReferencedSymbols(const std::string &path);
+
+    /// @brief Runs the thin link and the backends.
+    /// @param objects Receives the emitted objects, in no particular order.
+    /// @return False if an error has occured, after printing it.
+    bool run(std::vector<llvm::SmallVector<char, 0>> &objects);
+
+  private:
+    CodeGenOptions options_;
+    unsigned jobs_;
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers_;
+    std::set<std::string> preserved_;
+  };
+
+} // namespace codegen
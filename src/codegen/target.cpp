@@ -0,0 +1,234 @@
+#include "target.hpp"
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/StandardInstrumentations.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/TargetParser/Host.h>
+#include <llvm/TargetParser/SubtargetFeature.h>
+#include <algorithm>
+#include <mutex>
+
+namespace codegen
+{
+
+  static llvm::OptimizationLevel toPassBuilderLevel(OptLevel level)
+  {
+    switch (level)
+    {
+    case OptLevel::O0:
+      return llvm::OptimizationLevel::O0;
+    case OptLevel::O1:
+      return llvm::OptimizationLevel::O1;
+    case OptLevel::O2:
+      return llvm::OptimizationLevel::O2;
+    case OptLevel::O3:
+      return llvm::OptimizationLevel::O3;
+    case OptLevel::Os:
+      return llvm::OptimizationLevel::Os;
+    case OptLevel::Oz:
+      return llvm::OptimizationLevel::Oz;
+    }
+    return llvm::OptimizationLevel::O0;
+  }
+
+  llvm::CodeGenOptLevel toCodeGenLevel(OptLevel level)
+  {
+    switch (level)
+    {
+    case OptLevel::O0:
+      return llvm::CodeGenOptLevel::None;
+    case OptLevel::O1:
+      return llvm::CodeGenOptLevel::Less;
+    case OptLevel::O3:
+      return llvm::CodeGenOptLevel::Aggressive;
+    default:
+      return llvm::CodeGenOptLevel::Default;
+    }
+  }
+
+  void initializeNativeTarget()
+  {
+    // Target registration isn't thread-safe and the driver may create
+    // several code generators at once.
+    static std::once_flag initTargets;
+    std::call_once(initTargets, []()
+                   {
+      llvm::InitializeNativeTarget();
+      llvm::InitializeNativeTargetAsmPrinter(); });
+  }
+
+  void resolveTarget(const CodeGenOptions &options, std::string &cpu,
+                     std::string &features)
+  {
+    cpu = options.cpu.empty() ? "generic" : options.cpu;
+    features.clear();
+    if (cpu == "native")
+    {
+      cpu = llvm::sys::getHostCPUName().str();
+      llvm::SubtargetFeatures hostFeatures;
+      for (const auto &feature : llvm::sys::getHostCPUFeatures())
+        hostFeatures.AddFeature(feature.getKey(), feature.getValue());
+      features = hostFeatures.getString();
+    }
+
+    // Explicit -mattr features come last so they override the host ones.
+    if (!options.features.empty())
+    {
+      if (!features.empty())
+        features += ',';
+      features += options.features;
+    }
+  }
+
+  bool checkTarget(const CodeGenOptions &options, std::string &error)
+  {
+    initializeNativeTarget();
+
+    auto targetTripleStr = llvm::sys::getDefaultTargetTriple();
+    llvm::Triple triple(targetTripleStr);
+    const auto *target = llvm::TargetRegistry::lookupTarget(targetTripleStr, error);
+    if (!target)
+      return false;
+
+    std::string cpu, features;
+    resolveTarget(options, cpu, features);
+    std::unique_ptr<llvm::MCSubtargetInfo> info(
+        target->createMCSubtargetInfo(triple, cpu, ""));
+    if (!info->isCPUStringValid(cpu))
+    {
+      error = "'" + cpu + "' is not a recognized processor for this target";
+      return false;
+    }
+
+    // Only -mattr is checked, the host features of "native" come from LLVM.
+    llvm::SmallVector<llvm::StringRef, 8> requested;
+    llvm::StringRef(options.features).split(requested, ',', -1, false);
+    auto known = info->getAllProcessorFeatures();
+    for (llvm::StringRef feature : requested)
+    {
+      if (!llvm::SubtargetFeatures::hasFlag(feature))
+      {
+        error = "feature '" + feature.str() + "' has to start with '+' or '-'";
+        return false;
+      }
+      llvm::StringRef name = llvm::SubtargetFeatures::StripFlag(feature);
+      bool found = std::any_of(known.begin(), known.end(), [&](const auto &kv)
+                               { return name == kv.Key; });
+      if (!found)
+      {
+        error = "'" + name.str() + "' is not a recognized feature for this target";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string describeTarget(const CodeGenOptions &options)
+  {
+    std::string cpu, features;
+    resolveTarget(options, cpu, features);
+    return llvm::sys::getDefaultTargetTriple() + ";" + cpu + ";" + features +
+           ";O" + std::to_string(static_cast<int>(options.optLevel));
+  }
+
+  std::unique_ptr<llvm::TargetMachine>
+  createTargetMachine(const CodeGenOptions &options)
+  {
+    initializeNativeTarget();
+
+    auto targetTripleStr = llvm::sys::getDefaultTargetTriple();
+    llvm::Triple triple(targetTripleStr);
+    std::string error;
+    const auto *target = llvm::TargetRegistry::lookupTarget(targetTripleStr, error);
+    if (!target)
+    {
+      llvm::errs() << "Target lookup failed: " << error << "\n";
+      return nullptr;
+    }
+
+    std::string cpu, features;
+    resolveTarget(options, cpu, features);
+
+    llvm::TargetOptions opts;
+    return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+        triple, cpu, features, opts, llvm::Reloc::PIC_, std::nullopt,
+        toCodeGenLevel(options.optLevel)));
+  }
+
+  void configureModule(llvm::Module &module, const llvm::TargetMachine &tm)
+  {
+    module.setTargetTriple(tm.getTargetTriple());
+    module.setDataLayout(tm.createDataLayout());
+  }
+
+  void optimizeModule(llvm::Module &module, llvm::TargetMachine &tm,
+                      OptLevel level, PipelineKind kind)
+  {
+    if (level == OptLevel::O0)
+      return;
+
+    llvm::PipelineTuningOptions pto;
+    pto.LoopUnrolling = level != OptLevel::O1;
+    pto.LoopVectorization = level == OptLevel::O2 || level == OptLevel::O3 ||
+                            level == OptLevel::Os;
+    pto.SLPVectorization = pto.LoopVectorization || level == OptLevel::Oz;
+
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+
+    // Records every pass as a span when -ftime-trace is enabled on this
+    // thread, a no-op otherwise.
+    llvm::PassInstrumentationCallbacks pic;
+    llvm::TimeProfilingPassesHandler timeProfiling;
+    timeProfiling.registerCallbacks(pic);
+
+    llvm::PassBuilder pb(&tm, pto, std::nullopt, &pic);
+    pb.registerModuleAnalyses(mam);
+    pb.registerCGSCCAnalyses(cgam);
+    pb.registerFunctionAnalyses(fam);
+    pb.registerLoopAnalyses(lam);
+    pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+    llvm::ModulePassManager mpm;
+    switch (kind)
+    {
+    case PipelineKind::PerModule:
+      mpm = pb.buildPerModuleDefaultPipeline(toPassBuilderLevel(level));
+      break;
+    case PipelineKind::ThinLTOPreLink:
+      mpm = pb.buildThinLTOPreLinkDefaultPipeline(toPassBuilderLevel(level));
+      break;
+    case PipelineKind::FullLTO:
+      mpm = pb.buildLTODefaultPipeline(toPassBuilderLevel(level),
+                                       /*ExportSummary=*/nullptr);
+      break;
+    }
+    mpm.run(module, mam);
+  }
+
+  bool emitObject(llvm::Module &module, llvm::TargetMachine &tm,
+                  llvm::raw_pwrite_stream &dest)
+  {
+    llvm::legacy::PassManager pm;
+    if (tm.addPassesToEmitFile(pm, dest, nullptr,
+                               llvm::CodeGenFileType::ObjectFile))
+    {
+      llvm::errs() << "TargetMachine cannot emit object file\n";
+      return false;
+    }
+
+    // TODO: Improve handling of verifying the module.
+    bool is_broken = llvm::verifyModule(module, &llvm::errs());
+
+    if (!is_broken)
+      pm.run(module);
+    return !is_broken;
+  }
+
+} // namespace codegen
@@ -0,0 +1,59 @@
+#pragma once
+#include "codegen_options.hpp"
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <string>
+
+namespace codegen
+{
+
+  /// @brief Which default pass pipeline optimizeModule() builds.
+  enum class PipelineKind : uint8_t
+  {
+    PerModule,      ///< Regular per translation unit pipeline.
+    ThinLTOPreLink, ///< Per translation unit pipeline for ThinLTO bitcode.
+    FullLTO,        ///< Post-link pipeline for a merged whole-program module.
+  };
+
+  /// @brief Registers the native target, safe to call from any thread.
+  void initializeNativeTarget();
+
+  /// @brief Resolves the CPU name ("native" becomes the host CPU) and the
+  /// feature string (host features followed by -mattr) of the options.
+  void resolveTarget(const CodeGenOptions &options, std::string &cpu,
+                     std::string &features);
+
+  /// @brief Checks that the CPU and the -mattr features of the options are
+  /// known to the host target.
+  /// @return False, with the reason in error, if one of them isn't.
+  bool checkTarget(const CodeGenOptions &options, std::string &error);
+
+  /// @brief Describes everything the options resolve to that affects the
+  /// emitted code (triple, CPU, features, optimization level), used to key
+  /// caches of compiled objects.
+  std::string describeTarget(const CodeGenOptions &options);
+
+  /// @brief Maps an optimization level to the backend one.
+  llvm::CodeGenOptLevel toCodeGenLevel(OptLevel level);
+
+  /// @brief Creates a target machine for the host triple.
+  /// @return Null (after printing the reason) if the target is unavailable.
+  std::unique_ptr<llvm::TargetMachine>
+  createTargetMachine(const CodeGenOptions &options);
+
+  /// @brief Stamps the module with the triple and data layout of the target.
+  void configureModule(llvm::Module &module, const llvm::TargetMachine &tm);
+
+  /// @brief Runs the default pipeline of the given kind for the level.
+  /// Does nothing at -O0.
+  void optimizeModule(llvm::Module &module, llvm::TargetMachine &tm,
+                      OptLevel level, PipelineKind kind);
+
+  /// @brief Verifies the module and runs the backend into dest.
+  /// @return False if the module is broken or can't be emitted.
+  bool emitObject(llvm::Module &module, llvm::TargetMachine &tm,
+                  llvm::raw_pwrite_stream &dest);
+
+} // namespace codegen
@@ -0,0 +1,86 @@
+#include "driver/cache.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/BLAKE3.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace zap {
+
+bool object_cache::open(const std::filesystem::path &directory,
+                        std::string &error) {
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (ec) {
+    error = ec.message();
+    return true;
+  }
+  dir = directory;
+  return false;
+}
+
+std::string object_cache::key(std::string_view source,
+                              std::string_view config) {
+  llvm::BLAKE3 hasher;
+  hasher.update(llvm::StringRef(config.data(), config.size()));
+  // Separates the two parts so moving bytes between them changes the key.
+  hasher.update(llvm::StringRef("\0", 1));
+  hasher.update(llvm::StringRef(source.data(), source.size()));
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::filesystem::path object_cache::entryPath(const std::string &key) const {
+  return dir / key.substr(0, 2) / (key.substr(2) + ".o");
+}
+
+std::optional<std::filesystem::path>
+object_cache::lookup(const std::string &key) const {
+  if (!enabled())
+    return std::nullopt;
+
+  std::filesystem::path path = entryPath(key);
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path, ec))
+    return std::nullopt;
+  return path;
+}
+
+bool object_cache::store(const std::string &key, const char *data, size_t size,
+                         std::string &error) const {
+  std::filesystem::path path = entryPath(key);
+
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  if (ec) {
+    error = ec.message();
+    return true;
+  }
+
+  int fd;
+  llvm::SmallString<128> tmp;
+  std::string model = (path.parent_path() / "%%%%%%%%.tmp").string();
+  if (auto err = llvm::sys::fs::createUniqueFile(model, fd, tmp)) {
+    error = err.message();
+    return true;
+  }
+
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  os.write(data, size);
+  os.close();
+  if (os.has_error()) {
+    error = os.error().message();
+    os.clear_error();
+    llvm::sys::fs::remove(tmp);
+    return true;
+  }
+
+  if (auto err = llvm::sys::fs::rename(tmp, path.string())) {
+    error = err.message();
+    llvm::sys::fs::remove(tmp);
+    return true;
+  }
+
+  return false;
+}
+
+} // namespace zap
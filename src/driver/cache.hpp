@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace zap {
+
+/// @brief Content-addressed on-disk cache of compiled object files.
+/// Entries are keyed by a hash of everything that affects the emitted code
+/// and stored as <dir>/<first two hex digits>/<rest of the key>.o. Entries are
+/// written to a temporary file and renamed into place, so concurrent zapc
+/// processes sharing a cache never observe partial objects.
+class object_cache {
+public:
+  /// @brief Enables the cache, creating the directory if needed.
+  /// @return True if an error has occured, the cache stays disabled.
+  bool open(const std::filesystem::path &directory, std::string &error);
+
+  /// @brief Returns whether the cache has been opened.
+  bool enabled() const noexcept { return !dir.empty(); }
+
+  /// @brief Computes the key of a translation unit.
+  /// @param source Contents of the source file.
+  /// @param config Description of every compiler setting that affects the
+  /// output.
+  static std::string key(std::string_view source, std::string_view config);
+
+  /// @brief Returns the path of the cached object, if there is one.
+  std::optional<std::filesystem::path> lookup(const std::string &key) const;
+
+  /// @brief Stores an object file under the provided key.
+  /// @return True if an error has occured.
+  bool store(const std::string &key, const char *data, size_t size,
+             std::string &error) const;
+
+private:
+  std::filesystem::path dir; ///< Cache directory, empty if disabled.
+
+  std::filesystem::path entryPath(const std::string &key) const;
+};
+
+} // namespace zap
@@ -1,54 +1,110 @@
 #include "driver/driver.hpp"
+#include "codegen/jit.hpp"
 #include "codegen/llvm_codegen.hpp"
+#include "codegen/lto.hpp"
+#include "codegen/target.hpp"
 #include "driver/compiler.hpp"
+#include "driver/linker.hpp"
+#include "driver/phase_scope.hpp"
 #include "ir/ir_generator.hpp"
-#include "lexer/lexer.hpp"
+#include "parser/parallel_parse.hpp"
 #include "parser/parser.hpp"
 #include "sema/binder.hpp"
 #include "sema/bound_nodes.hpp"
+#include "sema/constant_folder.hpp"
+#include "utils/arena.hpp"
 #include "utils/diagnostics.hpp"
 #include "utils/stream.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <iostream>
 #include <string_view>
+#include <thread>
 
 namespace zap {
 
+struct driver::unit_result {
+  std::filesystem::path object;      ///< Emitted object file, if any.
+  llvm::SmallVector<char, 0> buffer; ///< Object or bitcode in memory.
+};
+
 driver::driver() {}
 
+driver::~driver() = default;
+
 bool driver::parseArgs(int argc, char **argv) {
   std::vector<std::string_view> args;
   for (int i = 1; i < argc; ++i) {
     args.emplace_back(argv[i]);
   }
 
+  bool run_mode = false;
   bool emit_llvm = false;
   bool emit_zir = false;
+  bool emit_outline = false;
+  bool syntax_only = false;
   bool emit_s = false;
   bool nolink = false;
   std::string_view output_str = "a.out";
   implicit_output = true;
   inc_stdlib = true;
 
+  if (!args.empty() && args.front() == "run") {
+    run_mode = true;
+    args.erase(args.begin());
+  }
+
   for (size_t i = 0; i < args.size(); ++i) {
     auto arg = args[i];
 
     if (arg == "--help") {
       out()
           << "Zap Compiler [options] <file>\n"
+          << "Zap Compiler run [options] <file>\n"
           << "Zap Compiler\n\n"
+          << "Commands:\n"
+          << "  run             Compile and run the program in-process without\n"
+          << "                  writing any files, exits with the status main\n"
+          << "                  returns\n\n"
           << "Options:\n"
           << "  --help          Display available options\n"
           << "  --version       Print version information\n"
           << "  -o <file>       Write output to <file>\n"
+          << "  -O<level>       Optimization level (0, 1, 2, 3, s, z)\n"
+          << "  -j <jobs>       Compile with up to <jobs> threads\n"
+          << "  --cache-dir <dir>\n"
+          << "                  Reuse objects of unchanged sources from <dir>\n"
+          << "                  (default: $ZAPC_CACHE_DIR)\n"
+          << "  -march=<cpu>    Generate code for <cpu>, 'native' for the host\n"
+          << "  -mcpu=<cpu>     Same as -march=<cpu>\n"
+          << "  -mattr=<attrs>  Enable or disable target features (+avx2,-fma)\n"
           << "  -nostdlib       Stops the linker from linking the zap stdlib\n"
           << "  -c              Compile and assemble but not link\n"
+          << "  -fuse-ld=<ld>   Link through the system C compiler using <ld>\n"
+          << "  -ftime-report   Print the time spent in every compiler phase\n"
+          << "  -ftime-trace[=<file>]\n"
+          << "                  Write a Chrome trace of the compilation to <file>\n"
+          << "                  (default: <output>.time-trace)\n"
+          << "  -ftime-trace-granularity=<us>\n"
+          << "                  Shortest span recorded by -ftime-trace (500)\n"
+          << "  -flto[=full|thin]\n"
+          << "                  Optimize across files at link time, full merges\n"
+          << "                  everything into one module, thin optimizes files\n"
+          << "                  in parallel (-fno-lto to disable)\n"
           << "  -S              Compile only no assembling or linking\n"
           << "  -emit-llvm      Emit LLVM IR instead of final output\n"
-          << "  -emit-zir       Emit ZIR instead of final output\n";
+          << "  -emit-zir       Emit ZIR instead of final output\n"
+          << "  -emit-outline   Emit the top-level declarations, without parsing\n"
+          << "                  function bodies\n"
+          << "  -fsyntax-only   Only check the sources, write nothing\n";
       return false;
     } else if (arg == "--version") {
       out() << "Zap Compiler v" << zap::ZAP_VERSION << '\n';
@@ -64,8 +120,92 @@ bool driver::parseArgs(int argc, char **argv) {
     } else if (arg.substr(0, 2) == "-o") {
       output_str = arg.substr(2);
       implicit_output = false;
+    } else if (arg == "--cache-dir") {
+      if (i + 1 < args.size()) {
+        cache_dir = args[++i];
+      } else {
+        reportError("argument to '--cache-dir' is missing");
+        return false;
+      }
+    } else if (arg.substr(0, 12) == "--cache-dir=") {
+      cache_dir = arg.substr(12);
     } else if (arg == "-nostdlib") {
       inc_stdlib = false;
+    } else if (arg.substr(0, 7) == "-march=" || arg.substr(0, 6) == "-mcpu=") {
+      auto cpu = arg.substr(arg.find('=') + 1);
+      if (cpu.empty()) {
+        reportError("missing cpu name in '", arg, "'");
+        return false;
+      }
+      codegen_opts.cpu = std::string(cpu);
+    } else if (arg.substr(0, 7) == "-mattr=") {
+      if (!codegen_opts.features.empty())
+        codegen_opts.features += ',';
+      codegen_opts.features += arg.substr(7);
+    } else if (arg.substr(0, 2) == "-j") {
+      std::string_view count = arg.substr(2);
+      if (count.empty()) {
+        if (i + 1 >= args.size()) {
+          reportError("argument to '-j' is missing");
+          return false;
+        }
+        count = args[++i];
+      }
+      auto res = std::from_chars(count.data(), count.data() + count.size(),
+                                 jobs);
+      if (res.ec != std::errc() || res.ptr != count.data() + count.size() ||
+          jobs == 0) {
+        reportError("invalid job count: ", count);
+        return false;
+      }
+    } else if (arg.substr(0, 2) == "-O") {
+      auto level = arg.substr(2);
+      if (level.empty() || level == "1")
+        codegen_opts.optLevel = codegen::OptLevel::O1;
+      else if (level == "0")
+        codegen_opts.optLevel = codegen::OptLevel::O0;
+      else if (level == "2")
+        codegen_opts.optLevel = codegen::OptLevel::O2;
+      else if (level == "3")
+        codegen_opts.optLevel = codegen::OptLevel::O3;
+      else if (level == "s")
+        codegen_opts.optLevel = codegen::OptLevel::Os;
+      else if (level == "z")
+        codegen_opts.optLevel = codegen::OptLevel::Oz;
+      else {
+        reportError("invalid optimization level: ", arg);
+        return false;
+      }
+    } else if (arg.substr(0, 9) == "-fuse-ld=") {
+      fuse_ld = std::string(arg.substr(9));
+      if (fuse_ld.empty()) {
+        reportError("missing linker name in '", arg, "'");
+        return false;
+      }
+    } else if (arg == "-flto" || arg == "-flto=full") {
+      lto = lto_mode::FULL;
+    } else if (arg == "-flto=thin") {
+      lto = lto_mode::THIN;
+    } else if (arg == "-fno-lto") {
+      lto = lto_mode::NONE;
+    } else if (arg.substr(0, 6) == "-flto=") {
+      reportError("unsupported LTO mode: ", arg.substr(6));
+      return false;
+    } else if (arg == "-ftime-report") {
+      timers.enable();
+    } else if (arg == "-ftime-trace") {
+      time_trace = true;
+    } else if (arg.substr(0, 13) == "-ftime-trace=") {
+      time_trace = true;
+      time_trace_path = arg.substr(13);
+    } else if (arg.substr(0, 25) == "-ftime-trace-granularity=") {
+      auto value = arg.substr(25);
+      auto res = std::from_chars(value.data(), value.data() + value.size(),
+                                 codegen_opts.timeTraceGranularity);
+      if (res.ec != std::errc() || res.ptr != value.data() + value.size()) {
+        reportError("invalid time trace granularity: ", value);
+        return false;
+      }
     } else if (arg == "-c") {
       nolink = true;
     } else if (arg == "-S") {
@@ -74,6 +214,10 @@ bool driver::parseArgs(int argc, char **argv) {
       emit_llvm = true;
     } else if (arg == "-emit-zir") {
       emit_zir = true;
+    } else if (arg == "-emit-outline") {
+      emit_outline = true;
+    } else if (arg == "-fsyntax-only") {
+      syntax_only = true;
     } else if (arg.substr(0, 1) == "-") {
       reportError("unknown argument: ", arg);
       return false;
@@ -82,11 +226,17 @@ bool driver::parseArgs(int argc, char **argv) {
     }
   }
 
-  if (emit_llvm && emit_zir) {
+  if (emit_llvm + emit_zir + emit_outline + syntax_only > 1) {
     reportError("choosing multiple emit modes isn't allowed");
     return false;
   }
 
+  if (run_mode && (emit_llvm || emit_zir || emit_outline || syntax_only ||
+                   emit_s || nolink)) {
+    reportError("'run' can't be combined with -c, -S, -emit-* or -fsyntax-only");
+    return false;
+  }
+
   if (emit_s) {
     if (emit_llvm)
       out_type = output_type::TEXT_LLVM;
@@ -97,6 +247,10 @@ bool driver::parseArgs(int argc, char **argv) {
 
   if (emit_zir)
     out_type = output_type::ZIR;
+  else if (emit_outline)
+    out_type = output_type::OUTLINE;
+  else if (syntax_only)
+    out_type = output_type::SYNTAX;
 
   if (out_type == output_type::EXEC) {
     if (nolink) {
@@ -104,8 +258,16 @@ bool driver::parseArgs(int argc, char **argv) {
     }
   }
 
+  if (run_mode)
+    out_type = output_type::JIT;
+
   output = std::filesystem::path(output_str);
 
+  if (cache_dir.empty()) {
+    if (const char *env = std::getenv("ZAPC_CACHE_DIR"))
+      cache_dir = env;
+  }
+
   if (!inputs.empty()) {
     return true;
   }
@@ -124,6 +286,8 @@ bool driver::splitInputs() {
       sources.emplace_back(std::move(input_path));
     } else if (ext == ".a" || ext == ".o") {
       objects.emplace_back(std::move(input_path));
+    } else if (ext == ".bc") {
+      bitcodes.emplace_back(std::move(input_path));
     } else {
       reportError("unknown input type: ", input);
       return true;
@@ -136,24 +300,37 @@ bool driver::splitInputs() {
 bool driver::verifyOutput() {
   const zap::driver::output_type &emit_type = get_output_type();
 
-  bool per_file_emit = (emit_type != output_type::EXEC);
+  bool per_file_emit =
+      (emit_type != output_type::EXEC && emit_type != output_type::JIT);
 
   if (per_file_emit && get_inputs().size() > 1 && !is_implicit_output()) {
     reportError("cannot specify -o with multiple input files");
     return true;
   }
 
-  if (per_file_emit && !objects.empty()) {
+  if (per_file_emit && (!objects.empty() || !bitcodes.empty())) {
     reportError(
         "cannot use object files or archives with the selected output mode");
     return true;
   }
 
+  if (lto != lto_mode::NONE && emit_type != output_type::EXEC) {
+    reportError("-flto is only supported when linking an executable");
+    return true;
+  }
+
   if (!format_supported()) {
     reportError("chosen file output mode is not yet supported in this version");
     return true;
   }
 
+  std::string target_error;
+  if ((!codegen_opts.cpu.empty() || !codegen_opts.features.empty()) &&
+      !codegen::checkTarget(codegen_opts, target_error)) {
+    reportError(target_error);
+    return true;
+  }
+
   return false;
 }
 
@@ -177,94 +354,291 @@ bool driver::verifySources() {
     if (verifyFile(input))
       return true;
   }
+  for (const std::filesystem::path &input : bitcodes) {
+    if (verifyFile(input))
+      return true;
+  }
   return false;
 }
 
-bool compileSourceZIR(sema::BoundRootNode &node, std::ostream &ofoutput) {
+bool compileSourceZIR(sema::BoundRootNode &node, std::ostream &ofoutput,
+                      Stream &log, time_report &timers,
+                      const std::string &source_name) {
   zir::BoundIRGenerator irGen;
-  auto mod = irGen.generate(node);
+  auto mod = time_phase(timers, phase::IRGEN, source_name,
+                        [&] { return irGen.generate(node); });
   if (mod) {
+    phase_scope timer(timers, phase::EMIT, source_name);
     ofoutput << mod->toString();
   } else {
-    driver::reportError("failed to generate ZIR");
+    driver::reportErrorTo(log, "failed to generate ZIR");
     return true;
   }
   return false;
 }
 
-bool driver::compileSourceFile(const std::string &source,
-                               const std::string &source_name) {
-  zap::DiagnosticEngine diagnostics(source, source_name);
-  Lexer lex(diagnostics);
+std::filesystem::path
+driver::objectOutputPath(const std::string &source_name) const {
+  return implicit_output
+             ? std::filesystem::path(source_name +
+                                     format_fileextension(out_type))
+             : output;
+}
+
+/// @brief Reads a whole source file into content.
+/// @return True if an error has occured.
+bool readSource(const std::filesystem::path &input, std::string &content,
+                Stream &log, time_report &timers) {
+  phase_scope timer(timers, phase::READ, input.string());
+  std::ifstream file(input, std::ios::binary | std::ios::ate);
+  if (!file) {
+    driver::reportErrorTo(log, "couldn't open the provided file: ", input,
+                          "\nreason: ", strerror(errno));
+    return true;
+  }
+
+  auto size = file.tellg();
+  // Source spans store 32-bit offsets.
+  if (static_cast<uint64_t>(size) > UINT32_MAX) {
+    driver::reportErrorTo(log, "provided file is too large: ", input);
+    return true;
+  }
+  content.assign(size, '\0');
+
+  if (size == 0) {
+    log << "warning: provided file is empty: " << input << '\n';
+  } else {
+    file.seekg(0);
+    file.read(content.data(), size);
+  }
+
+  return false;
+}
 
-  auto tokens = lex.tokenize(source);
+/// @brief Lexes, parses and binds a source file.
+/// @param threads How many threads big files may be parsed and bound with.
+/// @return The bound tree, null if an error has occured.
+std::unique_ptr<sema::BoundRootNode>
+analyzeSource(const std::string &source, const std::string &source_name,
+              Stream &log, time_report &timers, unsigned threads) {
+  zap::DiagnosticEngine diagnostics(source, source_name, log);
 
-  zap::Parser parser(tokens, diagnostics);
-  auto ast = parser.parse();
+  // The tree is only needed until it's bound, then it's freed at once.
+  zap::Arena arena;
+
+  // The parser pulls the tokens while it runs, so lexing is timed with it.
+  auto ast = time_phase(timers, phase::PARSE, source_name, [&] {
+    return zap::parseParallel(source, diagnostics, arena, threads);
+  });
 
   if (diagnostics.hadErrors()) {
-    return true;
+    return nullptr;
   }
 
   if (!ast) {
-    reportError(source_name, ": failed parsing the provided file");
-    return true;
+    driver::reportErrorTo(log, source_name,
+                          ": failed parsing the provided file");
+    return nullptr;
   }
 
   sema::Binder binder(diagnostics);
-  auto boundAst = binder.bind(*ast);
+  auto boundAst = time_phase(timers, phase::BIND, source_name,
+                             [&] { return binder.bind(*ast, threads); });
 
   if (!boundAst) {
-    reportError(source_name, ": semantic analysis failed");
-    return true;
+    driver::reportErrorTo(log, source_name, ": semantic analysis failed");
+    return nullptr;
   }
 
-  if (binary_output()) {
-    if (out_type == output_type::LLVM)
-      return true; // TODO: Implement LLVM bitcode emission.
+  // Both ZIR and LLVM IR are generated from the folded tree.
+  time_phase(timers, phase::BIND, source_name,
+             [&] { sema::ConstantFolder().fold(*boundAst); });
 
-    std::filesystem::path out_path;
+  return boundAst;
+}
 
-    if (out_type == output_type::EXEC) {
-      out_path = source_name + ".o";
-      cleanups.emplace_back(out_path);
-    } else if (out_type == output_type::OBJECT) {
-      if (implicit_output) {
-        out_path = source_name + ".o";
-      } else {
-        out_path = output;
-      }
-    }
+/// @brief Writes the signature of every top-level declaration of source to
+/// ofoutput, after the line it's on. Function bodies are skipped without
+/// being parsed, so errors inside them aren't reported.
+/// @return True if an error has occured.
+bool outlineSource(const std::string &source, const std::string &source_name,
+                   std::ostream &ofoutput, Stream &log, time_report &timers) {
+  zap::DiagnosticEngine diagnostics(source, source_name, log);
+  zap::Arena arena;
+  Lexer lexer(diagnostics);
+  TokenStream tokens(lexer, source);
+  zap::Parser parser(tokens, diagnostics, arena, zap::Parser::BodyMode::Lazy);
 
-    codegen::LLVMCodeGen llvmGen;
-    llvmGen.generate(*boundAst);
+  RootNode *root = time_phase(timers, phase::PARSE, source_name,
+                              [&] { return parser.parse(); });
+  if (diagnostics.hadErrors())
+    return true;
 
-    if (!llvmGen.emitObjectFile(out_path.string())) {
-      reportError("object file emission failed");
-      return true;
+  auto text = [&](const Node *node) {
+    return std::string_view(source).substr(node->span.offset,
+                                           node->span.length);
+  };
+  auto signature = [&](const zap::ArenaList<ParameterNode *> &params,
+                       const TypeNode *returnType) {
+    ofoutput << '(';
+    for (size_t i = 0; i < params.size(); ++i)
+      ofoutput << (i ? ", " : "") << params[i]->name.str() << ": "
+               << text(params[i]->type);
+    ofoutput << ')';
+    if (returnType)
+      ofoutput << ' ' << text(returnType);
+  };
+
+  zap::LineTable lines(source);
+  for (const Node *child : root->children) {
+    ofoutput << lines.lookup(child->span.offset).line << ' ';
+
+    if (auto funDecl = dyn_cast<FunDecl>(child)) {
+      ofoutput << "fun " << funDecl->name_.str();
+      signature(funDecl->params_, funDecl->returnType_);
+    } else if (auto extDecl = dyn_cast<ExtDecl>(child)) {
+      ofoutput << "ext fun " << extDecl->name_.str();
+      signature(extDecl->params_, extDecl->returnType_);
+    } else if (auto recordDecl = dyn_cast<RecordDecl>(child)) {
+      ofoutput << "record " << recordDecl->name_.str();
+    } else if (auto structDecl = dyn_cast<StructDeclarationNode>(child)) {
+      ofoutput << "struct " << structDecl->name_.str();
+    } else if (auto enumDecl = dyn_cast<EnumDecl>(child)) {
+      ofoutput << "enum " << enumDecl->name_.str();
+    } else if (auto constDecl = dyn_cast<ConstDecl>(child)) {
+      ofoutput << "const " << constDecl->name_.str() << ": "
+               << text(constDecl->type_);
+    } else if (auto varDecl = dyn_cast<VarDecl>(child)) {
+      ofoutput << "global var " << varDecl->name_.str();
+      if (varDecl->type_)
+        ofoutput << ": " << text(varDecl->type_);
     }
+    ofoutput << '\n';
+  }
 
-    objects.emplace_back(std::move(out_path));
-  } else {
-    std::filesystem::path out_path =
-        implicit_output ? std::filesystem::path(source_name +
-                                                format_fileextension(out_type))
-                        : output;
+  return !ofoutput;
+}
 
-    std::ofstream ofoutput(out_path, std::ios::binary);
+/// @brief Parses and binds source without generating anything. The
+/// declarations are parsed first and every function body on its own after,
+/// so a syntax error stops at the end of its body.
+/// @return True if an error has occured.
+bool checkSource(const std::string &source, const std::string &source_name,
+                 Stream &log, time_report &timers, unsigned threads) {
+  zap::DiagnosticEngine diagnostics(source, source_name, log);
+  zap::Arena arena;
+  Lexer lexer(diagnostics);
+  TokenStream tokens(lexer, source);
+  zap::Parser parser(tokens, diagnostics, arena, zap::Parser::BodyMode::Lazy);
 
-    if (!ofoutput) {
-      reportError("couldn't open the provided file: ", out_path,
+  RootNode *root = time_phase(timers, phase::PARSE, source_name, [&] {
+    RootNode *declarations = parser.parse();
+    for (Node *child : declarations->children)
+      if (auto funDecl = dyn_cast<FunDecl>(child))
+        parser.parseBody(*funDecl);
+    return declarations;
+  });
+  if (diagnostics.hadErrors())
+    return true;
+
+  sema::Binder binder(diagnostics);
+  auto boundAst = time_phase(timers, phase::BIND, source_name,
+                             [&] { return binder.bind(*root, threads); });
+  if (!boundAst) {
+    driver::reportErrorTo(log, source_name, ": semantic analysis failed");
+    return true;
+  }
+  return false;
+}
+
+bool driver::openTextOutput(const std::string &source_name,
+                            std::ofstream &file, Stream &log) const {
+  std::filesystem::path out_path =
+      implicit_output ? std::filesystem::path(source_name +
+                                              format_fileextension(out_type))
+                      : output;
+
+  file.open(out_path, std::ios::binary);
+  if (!file) {
+    reportErrorTo(log, "couldn't open the provided file: ", out_path,
                   "\nreason: ", strerror(errno));
+    return true;
+  }
+  return false;
+}
+
+bool driver::compileSourceFile(const std::string &source,
+                               const std::string &source_name, Stream &log,
+                               unit_result &result) const {
+  // Neither needs the bound tree of the whole file.
+  if (out_type == output_type::SYNTAX)
+    return checkSource(source, source_name, log, timers, unit_threads);
+  if (out_type == output_type::OUTLINE) {
+    std::ofstream ofoutput;
+    return openTextOutput(source_name, ofoutput, log) ||
+           outlineSource(source, source_name, ofoutput, log, timers);
+  }
+
+  auto boundAst =
+      analyzeSource(source, source_name, log, timers, unit_threads);
+  if (!boundAst)
+    return true;
+
+  auto generate = [&](codegen::LLVMCodeGen &gen) {
+    time_phase(timers, phase::IRGEN, source_name,
+               [&] { gen.generate(*boundAst); });
+  };
+  auto optimize = [&](codegen::LLVMCodeGen &gen, codegen::PipelineKind kind) {
+    return time_phase(timers, phase::OPTIMIZE, source_name,
+                      [&] { return gen.optimize(kind); });
+  };
+
+  if (binary_output()) {
+    codegen::LLVMCodeGen llvmGen(codegen_opts);
+    generate(llvmGen);
+
+    // Bitcode is always emitted for ThinLTO, which runs the rest of the
+    // pipeline at link time.
+    if (emits_bitcode()) {
+      if (!optimize(llvmGen, codegen::PipelineKind::ThinLTOPreLink)) {
+        reportErrorTo(log, "optimization failed");
+        return true;
+      }
+      phase_scope timer(timers, phase::EMIT, source_name);
+      if (!llvmGen.emitBitcodeToBuffer(result.buffer)) {
+        reportErrorTo(log, "bitcode emission failed");
+        return true;
+      }
+      return false;
+    }
+
+    if (!optimize(llvmGen, codegen::PipelineKind::PerModule)) {
+      reportErrorTo(log, "optimization failed");
+      return true;
+    }
+
+    // The object stays in memory, compileUnit() decides where it ends up.
+    phase_scope timer(timers, phase::EMIT, source_name);
+    if (!llvmGen.emitObjectToBuffer(result.buffer)) {
+      reportErrorTo(log, "object file emission failed");
       return true;
     }
+  } else {
+    std::ofstream ofoutput;
+    if (openTextOutput(source_name, ofoutput, log))
+      return true;
 
     if (out_type == output_type::ZIR) {
-      if (compileSourceZIR(*boundAst, ofoutput))
+      if (compileSourceZIR(*boundAst, ofoutput, log, timers, source_name))
         return true;
     } else if (out_type == output_type::TEXT_LLVM) {
-      codegen::LLVMCodeGen llvmGen;
-      llvmGen.generate(*boundAst);
+      codegen::LLVMCodeGen llvmGen(codegen_opts);
+      generate(llvmGen);
+      if (!optimize(llvmGen, codegen::PipelineKind::PerModule)) {
+        reportErrorTo(log, "optimization failed");
+        return true;
+      }
+      phase_scope timer(timers, phase::EMIT, source_name);
       // TODO: Avoid using LLVM types like raw_string_ostream here.
       std::string ir;
       llvm::raw_string_ostream rs(ir);
@@ -280,31 +654,333 @@ bool driver::compileSourceFile(const std::string &source,
   return false;
 }
 
-bool driver::compile() {
+bool driver::compileUnit(const std::filesystem::path &input, Stream &log,
+                         unit_result &result) const {
+  llvm::TimeTraceScope trace("Compile file", input.string());
+
+  std::string content;
+  if (readSource(input, content, log, timers))
+    return true;
+
+  const bool cacheable = cache.enabled() && binary_output();
+  std::string key;
+
+  if (cacheable) {
+    key = object_cache::key(content, cache_config);
+    if (auto hit = cache.lookup(key)) {
+      if (out_type == output_type::EXEC) {
+        result.object = std::move(*hit);
+        return false;
+      }
+
+      result.object = objectOutputPath(input.string());
+      std::error_code ec;
+      std::filesystem::copy_file(
+          *hit, result.object,
+          std::filesystem::copy_options::overwrite_existing, ec);
+      if (!ec)
+        return false;
+      reportWarningTo(log, "couldn't copy cached object to ", result.object,
+                      ": ", ec.message());
+    }
+  }
+
+  if (compileSourceFile(content, input.string(), log, result))
+    return true;
+
+  if (cacheable) {
+    std::string error;
+    if (cache.store(key, result.buffer.data(), result.buffer.size(), error))
+      reportWarningTo(log, "couldn't cache the object of ", input, ": ",
+                      error);
+  }
+
+  // Text outputs are written by compileSourceFile() itself.
+  if (binary_output() && !needs_linking()) {
+    result.object = objectOutputPath(input.string());
+
+    std::ofstream ofoutput(result.object, std::ios::binary);
+    ofoutput.write(result.buffer.data(), result.buffer.size());
+    if (!ofoutput) {
+      reportErrorTo(log, "couldn't write the output file: ", result.object,
+                    "\nreason: ", strerror(errno));
+      return true;
+    }
+    result.buffer.clear();
+  }
+
+  return false;
+}
+
+bool driver::compileLTO() {
+  codegen::LTOCodeGen lto_gen(codegen_opts);
+
+  // Every unit is generated straight into the context of the merged module,
+  // which isn't thread-safe, so this doesn't use the -j worker pool.
   for (const std::filesystem::path &input : sources) {
-    std::ifstream file(input, std::ios::binary | std::ios::ate);
-    if (!file) {
-      reportError("couldn't open the provided file: ", input,
-                  "\nreason: ", strerror(errno));
+    std::string content;
+    llvm::TimeTraceScope trace("Compile file", input.string());
+    if (readSource(input, content, err(), timers))
+      return true;
+
+    auto boundAst = analyzeSource(content, input.string(), err(), timers,
+                                  unit_threads);
+    if (!boundAst)
+      return true;
+
+    codegen::LLVMCodeGen llvmGen(lto_gen.getContext(), codegen_opts);
+    time_phase(timers, phase::IRGEN, input.string(),
+               [&] { llvmGen.generate(*boundAst); });
+
+    // ext functions may be defined by other objects or the stdlib, they have
+    // to keep their external linkage after internalization.
+    for (const auto &ext : boundAst->externalFunctions)
+      lto_gen.preserveSymbol(ext->symbol->name);
+
+    if (!lto_gen.addModule(llvmGen.takeModule())) {
+      reportError(input, ": couldn't link the module for LTO");
+      return true;
+    }
+  }
+
+  llvm::SmallVector<char, 0> buffer;
+  phase_scope timer(timers, phase::LTO);
+  if (!lto_gen.emitObjectToBuffer(buffer)) {
+    reportError("LTO object file emission failed");
+    return true;
+  }
+
+  std::string path;
+  if (memory_objects.add(buffer.data(), buffer.size(), path))
+    return true;
+  objects.emplace_back(std::move(path));
+  return false;
+}
+
+bool driver::compileThinLTO() {
+  if (!needs_linking() || (bitcodes.empty() && bitcode_buffers.empty()))
+    return false;
+
+  codegen::ThinLTOCodeGen thin(codegen_opts, jobs);
+
+  // Native inputs are only linked afterwards, whatever they reference has
+  // to survive internalization.
+  if (inc_stdlib && !thin.preserveReferencedSymbols(ZAPC_STDLIB_PATH))
+    return true;
+  for (const auto &obj : objects) {
+    if (!thin.preserveReferencedSymbols(obj.string()))
+      return true;
+  }
+
+  for (const auto &path : bitcodes) {
+    auto buffer = llvm::MemoryBuffer::getFile(path.string());
+    if (!buffer) {
+      reportError("couldn't open the provided file: ", path,
+                  "\nreason: ", buffer.getError().message());
       return true;
     }
+    thin.addBitcode(std::move(*buffer));
+  }
+  for (auto &buffer : bitcode_buffers)
+    thin.addBitcode(std::move(buffer));
+  bitcode_buffers.clear();
+
+  std::vector<llvm::SmallVector<char, 0>> thin_objects;
+  phase_scope timer(timers, phase::LTO);
+  if (!thin.run(thin_objects)) {
+    reportError("link time optimization failed");
+    return true;
+  }
+
+  for (const auto &obj : thin_objects) {
+    std::string path;
+    if (memory_objects.add(obj.data(), obj.size(), path))
+      return true;
+    objects.emplace_back(std::move(path));
+  }
+  return false;
+}
 
-    auto size = file.tellg();
-    std::string content(size, '\0');
+bool driver::compile() {
+  // Worker threads hand their spans over to this profiler when they finish,
+  // cleanup() writes all of them out.
+  if (time_trace)
+    llvm::timeTraceProfilerInitialize(codegen_opts.timeTraceGranularity,
+                                      ZAP_NAME);
+
+  size_t threads = jobs ? jobs : std::thread::hardware_concurrency();
+  threads = std::max<size_t>(threads, 1);
+
+  // Sources go through the merged module, .bc inputs through ThinLTO.
+  if (lto == lto_mode::FULL) {
+    unit_threads = threads;
+    return compileLTO() || compileThinLTO();
+  }
 
-    if (size == 0) {
-      err() << "warning: provided file is empty: " << input << '\n';
+  if (!cache_dir.empty()) {
+    std::string error;
+    if (cache.open(cache_dir, error)) {
+      reportWarning("object cache disabled, couldn't open ", cache_dir, ": ",
+                    error);
     } else {
-      file.seekg(0);
-      file.read(content.data(), size);
+      StringStream config(cache_config);
+      config << ZAP_NAME << ' ' << ZAP_VERSION << ';'
+             << codegen::describeTarget(codegen_opts)
+             << ";stdlib=" << inc_stdlib << ";bitcode=" << emits_bitcode();
     }
+  }
+
+  std::vector<unit_result> results(sources.size());
+
+  auto collect = [&](const std::filesystem::path &source,
+                     unit_result &result) {
+    if (emits_bitcode()) {
+      if (!result.buffer.empty())
+        bitcode_buffers.push_back(
+            std::make_unique<llvm::SmallVectorMemoryBuffer>(
+                std::move(result.buffer), source.string(),
+                /*RequiresNullTerminator=*/false));
+      if (!result.object.empty())
+        bitcodes.emplace_back(result.object);
+      return false;
+    }
+    if (!result.buffer.empty()) {
+      std::string path;
+      if (memory_objects.add(result.buffer.data(), result.buffer.size(), path))
+        return true;
+      objects.emplace_back(std::move(path));
+    }
+    if (!result.object.empty())
+      objects.emplace_back(result.object);
+    return false;
+  };
+
+  // Threads left over when there are fewer files than jobs go to the files,
+  // big ones are parsed and bound in parallel.
+  size_t workers = std::min(threads, sources.size());
+  unit_threads = std::max<size_t>(threads / std::max<size_t>(workers, 1), 1);
+
+  // Like the workers below, every unit is compiled so the diagnostics don't
+  // depend on the number of jobs.
+  if (workers <= 1) {
+    bool errors = false;
+    for (size_t i = 0; i < sources.size(); ++i) {
+      errors |= compileUnit(sources[i], err(), results[i]);
+      if (!errors && collect(sources[i], results[i]))
+        errors = true;
+      results[i] = unit_result();
+    }
+    return errors || compileThinLTO();
+  }
+
+  // Every unit writes its diagnostics into its own buffer, they are printed
+  // in input order once all workers are done.
+  std::vector<std::string> logs(sources.size());
+  std::vector<char> failed(sources.size(), 0);
+  std::atomic<size_t> next{0};
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < sources.size(); i = next++) {
+      StringStream log(logs[i], err().hasColors());
+      failed[i] = compileUnit(sources[i], log, results[i]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (size_t i = 1; i < workers; ++i) {
+    pool.emplace_back([&]() {
+      if (time_trace)
+        llvm::timeTraceProfilerInitialize(codegen_opts.timeTraceGranularity,
+                                          ZAP_NAME);
+      worker();
+      if (time_trace)
+        llvm::timeTraceProfilerFinishThread();
+    });
+  }
+  worker();
+  for (std::thread &t : pool)
+    t.join();
+
+  bool errors = false;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    err() << logs[i];
+    errors |= failed[i] != 0;
+    if (!errors && collect(sources[i], results[i]))
+      errors = true;
+  }
+
+  return errors || compileThinLTO();
+}
+
+bool driver::run(int &exit_code) {
+  if (time_trace)
+    llvm::timeTraceProfilerInitialize(codegen_opts.timeTraceGranularity,
+                                      ZAP_NAME);
+
+  codegen::JITRunner jit(codegen_opts);
+  unit_threads =
+      jobs ? jobs : std::max(std::thread::hardware_concurrency(), 1u);
+
+  for (const std::filesystem::path &input : sources) {
+    std::string content;
+    if (readSource(input, content, err(), timers))
+      return true;
+
+    auto boundAst = analyzeSource(content, input.string(), err(), timers,
+                                  unit_threads);
+    if (!boundAst)
+      return true;
 
-    file.close();
+    // Every module gets its own context so the JIT can compile them on
+    // its own threads.
+    auto ctx = std::make_unique<llvm::LLVMContext>();
+    codegen::LLVMCodeGen llvmGen(*ctx, codegen_opts);
+    time_phase(timers, phase::IRGEN, input.string(),
+               [&] { llvmGen.generate(*boundAst); });
 
-    if (compileSourceFile(content, input.string()))
+    if (!time_phase(timers, phase::OPTIMIZE, input.string(),
+                    [&] { return llvmGen.optimize(); })) {
+      reportError("optimization failed");
       return true;
+    }
+
+    if (!jit.addModule(llvmGen.takeModule(), std::move(ctx))) {
+      reportError(input, ": couldn't add the module to the JIT");
+      return true;
+    }
+  }
+
+  // The same stdlib object executables are linked with, loaded in-process.
+  if (inc_stdlib && !jit.addObjectFile(ZAPC_STDLIB_PATH)) {
+    reportError("couldn't load the stdlib");
+    return true;
+  }
+
+  for (const std::filesystem::path &obj : objects) {
+    bool archive =
+        llvm::StringRef(obj.extension().string()).equals_insensitive(".a");
+    if (archive ? !jit.addArchive(obj.string())
+                : !jit.addObjectFile(obj.string())) {
+      reportError("couldn't load ", obj);
+      return true;
+    }
+  }
+
+  for (const std::filesystem::path &bc : bitcodes) {
+    if (!jit.addBitcodeFile(bc.string())) {
+      reportError("couldn't load ", bc);
+      return true;
+    }
   }
 
+  err().flush();
+  out().flush();
+
+  if (!jit.runMain(exit_code)) {
+    reportError("running main failed");
+    return true;
+  }
   return false;
 }
 
@@ -312,21 +988,34 @@ bool driver::link() {
   if (!needs_linking())
     return false;
 
-  std::string cmd = "/usr/bin/cc ";
+  phase_scope timer(timers, phase::LINK, output.string());
 
-  if (inc_stdlib) {
-    cmd += std::string(ZAPC_STDLIB_PATH) + " ";
-  } else {
-    cmd += "-nostdlib ";
-  }
+  std::vector<std::string> link_inputs;
+  if (inc_stdlib)
+    link_inputs.emplace_back(ZAPC_STDLIB_PATH);
+  for (const auto &obj : objects)
+    link_inputs.emplace_back(obj.string());
 
-  for (const auto &obj : objects) {
-    cmd += obj.string() + " ";
+  if (fuse_ld.empty() && hasInProcessLinker()) {
+    if (linkInProcess(link_inputs, output.string(), inc_stdlib)) {
+      reportError("linking failed");
+      return true;
+    }
+    return false;
   }
 
-  cmd += "-o " + output.string();
+  std::vector<std::string> args = {"/usr/bin/cc"};
+
+  if (!inc_stdlib)
+    args.emplace_back("-nostdlib");
+  if (!fuse_ld.empty())
+    args.emplace_back("-fuse-ld=" + fuse_ld);
 
-  int res = std::system(cmd.c_str());
+  args.insert(args.end(), link_inputs.begin(), link_inputs.end());
+  args.emplace_back("-o");
+  args.emplace_back(output.string());
+
+  int res = runProgram(args);
   if (res != 0) {
     reportError("linking failed with exit code: ", res);
     return true;
@@ -338,13 +1027,20 @@ bool driver::link() {
 bool driver::cleanup() {
   bool errs = false;
 
-  for (const std::filesystem::path &f : cleanups) {
-    std::error_code ec;
-    std::filesystem::remove(f, ec);
-    if (ec) {
+  memory_objects.clear();
+
+  if (timers.enabled())
+    timers.print(err());
+
+  if (llvm::timeTraceProfilerEnabled()) {
+    // An empty preferred name makes LLVM write <output>.time-trace.
+    if (auto error = llvm::timeTraceProfilerWrite(time_trace_path.string(),
+                                                  output.string())) {
       errs = true;
-      reportWarning("failed to remove: ", f, "\nreason: ", ec.message());
+      reportWarning("couldn't write the time trace: ",
+                    llvm::toString(std::move(error)));
     }
+    llvm::timeTraceProfilerCleanup();
   }
 
   return errs;
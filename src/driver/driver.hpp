@@ -1,10 +1,21 @@
 #pragma once
 
+#include "codegen/codegen_options.hpp"
+#include "driver/cache.hpp"
+#include "driver/linker.hpp"
+#include "driver/timing.hpp"
 #include "utils/stream.hpp"
 #include <filesystem>
+#include <fstream>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+namespace llvm {
+class MemoryBuffer;
+} // namespace llvm
+
 namespace zap {
 
 /// @brief The class that drives the argument parsing.
@@ -16,6 +27,7 @@ namespace zap {
 class driver {
 public:
   driver();
+  ~driver();
 
   /// @brief Parses the provided args.
   /// @param argc How many arguments.
@@ -43,12 +55,19 @@ public:
   /// Should be called fifth after checking that the output is valid.
   bool compile();
 
+  /// @brief Compiles the sources and runs their main function in-process
+  /// with the JIT. Replaces compile() and link() for `zapc run`.
+  /// @param exit_code Receives the value returned by main.
+  /// @return True if an error has occured.
+  bool run(int &exit_code);
+
   /// @brief Links everything if the output mode requires it.
   /// @return True if an error has occured.
   /// Should be called sixth after compiling.
   bool link();
 
-  /// @brief Cleans up the files in the cleanup queue.
+  /// @brief Releases the objects compiled in memory, then prints the time
+  /// report and writes the time trace if they were requested.
   /// @return True if an error has occured.
   /// Should be called seventh after linking.
   bool cleanup();
@@ -81,6 +100,9 @@ public:
     TEXT_LLVM, ///< Textual LLVM IR (-S -emit-llvm).
     LLVM,      ///< LLVM IR (.bc).
     ZIR,       ///< ZIR.
+    OUTLINE,   ///< Top-level declarations, one per line (-emit-outline).
+    SYNTAX,    ///< Nothing, only check the sources (-fsyntax-only).
+    JIT,       ///< Nothing, run in-process (zapc run).
   };
 
   /// @brief Returns the chosen output type.
@@ -106,11 +128,17 @@ public:
       [[fallthrough]];
     case output_type::ZIR:
       [[fallthrough]];
+    case output_type::OUTLINE:
+      [[fallthrough]];
+    case output_type::SYNTAX:
+      [[fallthrough]];
     case output_type::TEXT_LLVM:
-      return true;
-    case output_type::ASM:
       [[fallthrough]];
     case output_type::LLVM:
+      [[fallthrough]];
+    case output_type::JIT:
+      return true;
+    case output_type::ASM:
       return false;
     }
     return false;
@@ -138,6 +166,8 @@ public:
       return ".bc";
     case output_type::ZIR:
       return ".zir";
+    case output_type::OUTLINE:
+      return ".outline";
     }
   }
 
@@ -156,41 +186,119 @@ public:
     case output_type::TEXT_LLVM:
       [[fallthrough]];
     case output_type::ZIR:
+      [[fallthrough]];
+    case output_type::OUTLINE:
+      [[fallthrough]];
+    case output_type::SYNTAX:
+      [[fallthrough]];
+    case output_type::JIT:
       return false;
     }
     return false;
   }
 
   template <typename... Args> static void reportError(Args &&...args) {
-    ((err() << "zapc: ").changeColor(Color::RED, true) << "error: ")
-        .resetColor();
-    (err() << ... << args);
-    err() << '\n';
+    reportErrorTo(err(), std::forward<Args>(args)...);
   }
 
   template <typename... Args> static void reportWarning(Args &&...args) {
-    ((err() << "zapc: ").changeColor(Color::YELLOW, true) << "warning: ")
+    reportWarningTo(err(), std::forward<Args>(args)...);
+  }
+
+  /// @brief Same as reportError() but writes to the provided stream.
+  template <typename... Args>
+  static void reportErrorTo(Stream &os, Args &&...args) {
+    ((os << "zapc: ").changeColor(Color::RED, true) << "error: ").resetColor();
+    (os << ... << args);
+    os << '\n';
+  }
+
+  /// @brief Same as reportWarning() but writes to the provided stream.
+  template <typename... Args>
+  static void reportWarningTo(Stream &os, Args &&...args) {
+    ((os << "zapc: ").changeColor(Color::YELLOW, true) << "warning: ")
         .resetColor();
-    (err() << ... << args);
-    err() << '\n';
+    (os << ... << args);
+    os << '\n';
   }
 
 private:
   std::vector<std::string> inputs;            ///< A vector of input files.
   std::vector<std::filesystem::path> sources; ///< A vector of .zap files.
   std::vector<std::filesystem::path> objects; ///< A vector of .o files.
-  std::vector<std::filesystem::path>
-      cleanups;                 ///< A vector of files that need to be deleted.
+  std::vector<std::filesystem::path> bitcodes; ///< A vector of .bc files.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>>
+      bitcode_buffers; ///< Bitcode compiled in memory for ThinLTO.
+  object_store memory_objects;  ///< Objects compiled in memory for linking.
   std::filesystem::path output; ///< Output file.
   output_type out_type =
       driver::output_type::EXEC; ///< Output type, default executable.
   bool implicit_output;          ///< Was the output implicit or explicit.
   bool inc_stdlib;               ///< Include the zap stdlib.o or not.
+  codegen::CodeGenOptions codegen_opts; ///< Options passed to LLVMCodeGen.
+  unsigned jobs = 0; ///< Parallel compile jobs (-j), 0 for hardware threads.
+  unsigned unit_threads = 1; ///< Threads a single file is analyzed with.
+  std::string fuse_ld; ///< Linker for the system C compiler (-fuse-ld=).
+
+  /// @brief Link time optimization modes (-flto).
+  enum class lto_mode : uint8_t {
+    NONE, ///< Every source is optimized and emitted on its own.
+    FULL, ///< All sources are merged and optimized as one module.
+    THIN, ///< Sources become bitcode that is optimized by ThinLTO.
+  };
+  lto_mode lto = lto_mode::NONE; ///< Chosen LTO mode.
+  mutable time_report timers; ///< Phase timings for -ftime-report.
+  bool time_trace = false;    ///< Write a Chrome trace (-ftime-trace).
+  std::filesystem::path time_trace_path; ///< Trace file, empty for default.
+  std::filesystem::path cache_dir; ///< Object cache directory, if any.
+  object_cache cache;              ///< Object cache, opened by compile().
+  std::string cache_config; ///< Compiler settings that are part of cache keys.
+
+  /// @brief Outputs of a single translation unit, filled by
+  /// compileSourceFile() and merged into objects or bitcode_buffers by
+  /// compile(). Defined in driver.cpp, it holds LLVM buffers.
+  struct unit_result;
+
+  /// @brief Reads and compiles a single source file, used internally by the
+  /// compile() function. Safe to call from multiple threads at once.
+  /// @param input Path of the source file.
+  /// @param log Stream that receives every diagnostic of this file.
+  /// @param result Receives the produced files.
+  /// @return True if an error has occured.
+  bool compileUnit(const std::filesystem::path &input, Stream &log,
+                   unit_result &result) const;
+
+  /// @brief Compiles every source into a single module, optimizes it as a
+  /// whole and emits one object, used by compile() with -flto.
+  /// @return True if an error has occured.
+  bool compileLTO();
+
+  /// @brief Links all bitcode, compiled with -flto=thin or given as .bc
+  /// inputs, with ThinLTO and adds the resulting objects to the link. Does
+  /// nothing if there is no bitcode or the output isn't linked.
+  /// @return True if an error has occured.
+  bool compileThinLTO();
+
+  /// @brief Returns whether sources are compiled to bitcode instead of
+  /// objects.
+  bool emits_bitcode() const noexcept {
+    return out_type == output_type::LLVM || lto == lto_mode::THIN;
+  }
+
+  /// @brief Returns the path an object or bitcode file for the source is
+  /// written to.
+  std::filesystem::path objectOutputPath(const std::string &source_name) const;
+
+  /// @brief Opens the text output of the source, like a .zir file.
+  /// @return True if an error has occured.
+  bool openTextOutput(const std::string &source_name, std::ofstream &file,
+                      Stream &log) const;
 
-  /// @brief Used internally by the compile() function.
+  /// @brief Used internally by compileUnit().
   /// @return True if an error has occured.
   bool compileSourceFile(const std::string &source,
-                         const std::string &source_name);
+                         const std::string &source_name, Stream &log,
+                         unit_result &result) const;
 };
 
 } // namespace zap
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "driver/linker.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef ZAPC_HAS_LLD
+#include <lld/Common/Driver.h>
+
+LLD_HAS_DRIVER(elf)
+#endif
+
+namespace zap {
+
+int runProgram(const std::vector<std::string> &args) {
+  if (args.empty())
+    return -1;
+
+  std::vector<llvm::StringRef> argv(args.begin(), args.end());
+  std::string error;
+  int res = llvm::sys::ExecuteAndWait(argv[0], argv, std::nullopt, {}, 0, 0,
+                                      &error);
+  if (!error.empty())
+    llvm::errs() << "zapc: " << error << '\n';
+  return res;
+}
+
+bool hasInProcessLinker() noexcept {
+#ifdef ZAPC_HAS_LLD
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool linkInProcess(const std::vector<std::string> &inputs,
+                   const std::string &output, bool startfiles) {
+#ifdef ZAPC_HAS_LLD
+  std::vector<std::string> args = {"ld.lld", "--eh-frame-hdr", "-o", output};
+
+  if (startfiles) {
+    args.insert(args.end(), {"-pie", "-dynamic-linker",
+                             ZAPC_LLD_DYNAMIC_LINKER, ZAPC_LLD_SCRT1_O,
+                             ZAPC_LLD_CRTI_O, ZAPC_LLD_CRTBEGINS_O});
+
+    llvm::SmallVector<llvm::StringRef, 8> dirs;
+    llvm::StringRef(ZAPC_LLD_LIB_DIRS).split(dirs, ':', -1, false);
+    for (llvm::StringRef dir : dirs)
+      args.emplace_back(("-L" + dir).str());
+  }
+
+  args.insert(args.end(), inputs.begin(), inputs.end());
+
+  if (startfiles) {
+    args.emplace_back("-lc");
+    if (llvm::StringRef(ZAPC_LLD_LIBGCC).starts_with("/"))
+      args.emplace_back(ZAPC_LLD_LIBGCC);
+    args.insert(args.end(), {ZAPC_LLD_CRTENDS_O, ZAPC_LLD_CRTN_O});
+  }
+
+  std::vector<const char *> argv;
+  argv.reserve(args.size());
+  for (const std::string &arg : args)
+    argv.push_back(arg.c_str());
+
+  lld::Result res = lld::lldMain(argv, llvm::outs(), llvm::errs(),
+                                 {{lld::Gnu, &lld::elf::link}});
+  return res.retCode != 0;
+#else
+  (void)inputs;
+  (void)output;
+  (void)startfiles;
+  return true;
+#endif
+}
+
+bool object_store::add(const char *data, size_t size, std::string &path) {
+#ifdef __linux__
+  // No MFD_CLOEXEC, the descriptor has to survive into the linker process
+  // when linking through the system C compiler.
+  int fd = memfd_create("zapc-object.o", 0);
+  if (fd != -1) {
+    size_t written = 0;
+    while (written < size) {
+      ssize_t res = ::write(fd, data + written, size - written);
+      if (res <= 0)
+        break;
+      written += size_t(res);
+    }
+    if (written == size) {
+      fds.push_back(fd);
+      path = "/proc/self/fd/" + std::to_string(fd);
+      return false;
+    }
+    ::close(fd);
+  }
+#endif
+
+  int fd_out;
+  llvm::SmallString<128> tmp;
+  if (auto ec = llvm::sys::fs::createTemporaryFile("zapc", "o", fd_out, tmp)) {
+    llvm::errs() << "zapc: couldn't create a temporary file: " << ec.message()
+                 << '\n';
+    return true;
+  }
+  files.emplace_back(tmp.str());
+
+  llvm::raw_fd_ostream os(fd_out, /*shouldClose=*/true);
+  os.write(data, size);
+  os.close();
+  if (os.has_error()) {
+    llvm::errs() << "zapc: couldn't write " << tmp << ": "
+                 << os.error().message() << '\n';
+    os.clear_error();
+    return true;
+  }
+
+  path = files.back();
+  return false;
+}
+
+void object_store::clear() noexcept {
+#ifdef __linux__
+  for (int fd : fds)
+    ::close(fd);
+#endif
+  fds.clear();
+
+  for (const std::string &file : files)
+    llvm::sys::fs::remove(file);
+  files.clear();
+}
+
+} // namespace zap
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace zap {
+
+/// @brief Runs a program directly, without going through a shell, so
+/// arguments containing spaces or shell characters are passed as-is.
+/// @param args Program path followed by its arguments.
+/// @return Exit code of the program, -1 if it couldn't be run.
+int runProgram(const std::vector<std::string> &args);
+
+/// @brief Returns whether zapc was built with LLD and can link executables
+/// in-process.
+bool hasInProcessLinker() noexcept;
+
+/// @brief Links an executable with the embedded LLD ELF driver.
+/// @param inputs Object files and archives, in link order.
+/// @param output Path of the executable.
+/// @param startfiles Whether the C runtime startup files and libc should be
+/// linked (false for -nostdlib).
+/// @return True if an error has occured.
+bool linkInProcess(const std::vector<std::string> &inputs,
+                   const std::string &output, bool startfiles);
+
+/// @brief Keeps object files that only exist in memory reachable by path so
+/// they can be passed to the linker. On Linux each object lives in an
+/// anonymous tmpfs file (memfd) and is exposed as /proc/self/fd/<n>, which
+/// the linker, or a child process inheriting the descriptor, can open.
+/// Elsewhere it falls back to a temporary file.
+class object_store {
+public:
+  object_store() = default;
+  object_store(const object_store &) = delete;
+  object_store &operator=(const object_store &) = delete;
+  ~object_store() { clear(); }
+
+  /// @brief Stores an object file.
+  /// @param data Contents of the object file.
+  /// @param size Size of the contents.
+  /// @param path Receives the path the linker should use.
+  /// @return True if an error has occured.
+  bool add(const char *data, size_t size, std::string &path);
+
+  /// @brief Releases every stored object.
+  void clear() noexcept;
+
+private:
+  std::vector<int> fds;            ///< Open memory files.
+  std::vector<std::string> files;  ///< Fallback temporary files.
+};
+
+} // namespace zap
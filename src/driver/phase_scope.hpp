@@ -0,0 +1,46 @@
+#pragma once
+
+#include "driver/timing.hpp"
+#include <chrono>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/TimeProfiler.h>
+
+namespace zap {
+
+/// @brief Measures a phase for the time report for as long as it is alive,
+/// and records it as a -ftime-trace span if tracing is enabled on the
+/// calling thread.
+class phase_scope {
+public:
+  /// @param detail Shown with the span in the trace, e.g. the file name.
+  phase_scope(time_report &report, phase p, llvm::StringRef detail = "")
+      : report(report), p(p), trace(phase_name(p), detail) {
+    if (report.enabled())
+      start = std::chrono::steady_clock::now();
+  }
+
+  phase_scope(const phase_scope &) = delete;
+  phase_scope &operator=(const phase_scope &) = delete;
+
+  ~phase_scope() {
+    if (report.enabled())
+      report.add(p, std::chrono::steady_clock::now() - start);
+  }
+
+private:
+  time_report &report;
+  phase p;
+  std::chrono::steady_clock::time_point start;
+  llvm::TimeTraceScope trace;
+};
+
+/// @brief Runs fn inside a phase_scope.
+/// @return Whatever fn returns.
+template <typename F>
+auto time_phase(time_report &report, phase p, llvm::StringRef detail,
+                F &&fn) {
+  phase_scope scope(report, p, detail);
+  return fn();
+}
+
+} // namespace zap
@@ -0,0 +1,57 @@
+#include "driver/timing.hpp"
+#include <cstdio>
+
+namespace zap {
+
+const char *phase_name(phase p) noexcept {
+  switch (p) {
+  case phase::READ:
+    return "Read";
+  case phase::PARSE:
+    return "Lex and parse";
+  case phase::BIND:
+    return "Bind";
+  case phase::IRGEN:
+    return "IR generation";
+  case phase::OPTIMIZE:
+    return "Optimization";
+  case phase::EMIT:
+    return "Emission";
+  case phase::LTO:
+    return "Link time optimization";
+  case phase::LINK:
+    return "Link";
+  case phase::COUNT:
+    break;
+  }
+  return "Unknown";
+}
+
+void time_report::print(Stream &os) const {
+  int64_t total = 0;
+  for (const auto &time : nanos)
+    total += time.load();
+
+  os << "===" << std::string(66, '-') << "===\n"
+     << "                        zapc time report\n"
+     << "    (wall time summed over all files, may exceed the real time "
+        "with -j)\n"
+     << "===" << std::string(66, '-') << "===\n"
+     << "   Wall time (s)   ---%---   Phase\n";
+
+  char line[128];
+  for (size_t i = 0; i < nanos.size(); ++i) {
+    int64_t time = nanos[i].load();
+    double percent = total ? 100.0 * double(time) / double(total) : 0.0;
+    std::snprintf(line, sizeof(line), "   %13.4f   %6.1f%%   %s\n",
+                  double(time) / 1e9, percent,
+                  phase_name(static_cast<phase>(i)));
+    os << line;
+  }
+
+  std::snprintf(line, sizeof(line), "   %13.4f   %6.1f%%   Total\n",
+                double(total) / 1e9, total ? 100.0 : 0.0);
+  os << line;
+}
+
+} // namespace zap
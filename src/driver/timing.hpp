@@ -0,0 +1,50 @@
+#pragma once
+
+#include "utils/stream.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace zap {
+
+/// @brief Phases of the compiler pipeline measured by -ftime-report.
+enum class phase : uint8_t {
+  READ,     ///< Reading source files.
+  PARSE,    ///< Parser::parse(), including the lexer it pulls tokens from.
+  BIND,     ///< Binder::bind() and constant folding.
+  IRGEN,    ///< BoundIRGenerator / LLVMCodeGen::generate().
+  OPTIMIZE, ///< LLVM optimization passes.
+  EMIT,     ///< Object, bitcode or textual output emission.
+  LTO,      ///< Link time optimization and its code generation.
+  LINK,     ///< Linking the executable.
+  COUNT,
+};
+
+/// @brief Returns the display name of a phase.
+const char *phase_name(phase p) noexcept;
+
+/// @brief Wall time spent in every phase, summed over all files and jobs.
+/// Safe to update from multiple threads at once.
+class time_report {
+public:
+  /// @brief Starts collecting timings, nothing is recorded before.
+  void enable() noexcept { active = true; }
+
+  /// @brief Returns whether timings are being collected.
+  bool enabled() const noexcept { return active; }
+
+  /// @brief Adds time spent in a phase.
+  void add(phase p, std::chrono::nanoseconds time) noexcept {
+    nanos[static_cast<size_t>(p)] += time.count();
+  }
+
+  /// @brief Prints the per-phase table.
+  void print(Stream &os) const;
+
+private:
+  bool active = false;
+  std::array<std::atomic<int64_t>, static_cast<size_t>(phase::COUNT)> nanos{};
+};
+
+} // namespace zap
@@ -4,9 +4,27 @@
 namespace zir
 {
 
+  /// @brief Returns how a literal is written in ZIR.
+  static std::string literalText(const sema::BoundLiteral &node)
+  {
+    const Type &type = *node.type;
+    if (type.getKind() == TypeKind::Bool)
+      return node.integer ? "true" : "false";
+    if (type.getKind() == TypeKind::Char)
+      return std::string(1, static_cast<char>(node.integer));
+    if (type.isFloatingPoint())
+      return std::to_string(node.real);
+    if (type.getKind() == TypeKind::Record)
+      return node.string.str();
+    if (type.isUnsigned())
+      return std::to_string(node.integer);
+    return std::to_string(static_cast<int64_t>(node.integer));
+  }
+
   std::unique_ptr<Module> BoundIRGenerator::generate(sema::BoundRootNode &root)
   {
     module_ = std::make_unique<Module>("zap_module");
+    types_ = root.types;
     root.accept(*this);
     return std::move(module_);
   }
@@ -48,7 +66,7 @@ namespace zir
       currentFunction_->arguments.push_back(arg);
 
       auto allocaReg =
-          createRegister(std::make_shared<PointerType>(paramSymbol->type));
+          createRegister(types_->getPointer(paramSymbol->type));
       currentBlock_->addInstruction(
           std::make_unique<AllocaInst>(allocaReg, paramSymbol->type));
       currentBlock_->addInstruction(std::make_unique<StoreInst>(arg, allocaReg));
@@ -112,7 +130,7 @@ namespace zir
   void BoundIRGenerator::visit(sema::BoundVariableDeclaration &node)
   {
     auto type = node.symbol->type;
-    auto reg = createRegister(std::make_shared<PointerType>(type));
+    auto reg = createRegister(types_->getPointer(type));
     currentBlock_->addInstruction(std::make_unique<AllocaInst>(reg, type));
     symbolMap_[node.symbol] = reg;
 
@@ -159,7 +177,7 @@ namespace zir
 
   void BoundIRGenerator::visit(sema::BoundLiteral &node)
   {
-    valueStack_.push(std::make_shared<Constant>(node.value, node.type));
+    valueStack_.push(std::make_shared<Constant>(literalText(node), node.type));
   }
 
   void BoundIRGenerator::visit(sema::BoundVariableExpression &node)
@@ -179,7 +197,7 @@ namespace zir
 
   void BoundIRGenerator::visit(sema::BoundBinaryExpression &node)
   {
-    if (node.op == "&&")
+    if (node.op == BinaryOp::And)
     {
       auto rhsLabel = createBlockLabel("and.rhs");
       auto mergeLabel = createBlockLabel("and.merge");
@@ -218,7 +236,7 @@ namespace zir
       return;
     }
 
-    if (node.op == "||")
+    if (node.op == BinaryOp::Or)
     {
       auto rhsLabel = createBlockLabel("or.rhs");
       auto mergeLabel = createBlockLabel("or.merge");
@@ -267,36 +285,52 @@ namespace zir
 
     auto reg = createRegister(node.type);
     bool isUnsigned = node.left->type->isUnsigned();
-    if (node.op == "==" || node.op == "!=" || node.op == "<" ||
-        (node.op == ">") || (node.op == "<=") || (node.op == ">="))
+    const char *pred = nullptr;
+    OpCode op = OpCode::Add;
+    switch (node.op)
     {
-      std::string pred;
-      if (node.op == "==") pred = "eq";
-      else if (node.op == "!=") pred = "ne";
-      else if (node.op == "<") pred = isUnsigned ? "ult" : "slt";
-      else if (node.op == ">") pred = isUnsigned ? "ugt" : "sgt";
-      else if (node.op == "<=") pred = isUnsigned ? "ule" : "sle";
-      else if (node.op == ">=") pred = isUnsigned ? "uge" : "sge";
+    case BinaryOp::Equal:
+      pred = "eq";
+      break;
+    case BinaryOp::NotEqual:
+      pred = "ne";
+      break;
+    case BinaryOp::Less:
+      pred = isUnsigned ? "ult" : "slt";
+      break;
+    case BinaryOp::Greater:
+      pred = isUnsigned ? "ugt" : "sgt";
+      break;
+    case BinaryOp::LessEqual:
+      pred = isUnsigned ? "ule" : "sle";
+      break;
+    case BinaryOp::GreaterEqual:
+      pred = isUnsigned ? "uge" : "sge";
+      break;
+    case BinaryOp::Sub:
+      op = OpCode::Sub;
+      break;
+    case BinaryOp::Mul:
+      op = OpCode::Mul;
+      break;
+    case BinaryOp::Div:
+      op = isUnsigned ? OpCode::UDiv : OpCode::SDiv;
+      break;
+    case BinaryOp::Mod:
+      op = isUnsigned ? OpCode::URem : OpCode::SRem;
+      break;
+    default:
+      op = OpCode::Add;
+      break;
+    }
 
+    if (pred)
+    {
       currentBlock_->addInstruction(
           std::make_unique<CmpInst>(pred, reg, left, right));
     }
     else
     {
-      OpCode op;
-      if (node.op == "+")
-        op = OpCode::Add;
-      else if (node.op == "-")
-        op = OpCode::Sub;
-      else if (node.op == "*")
-        op = OpCode::Mul;
-      else if (node.op == "/")
-        op = isUnsigned ? OpCode::UDiv : OpCode::SDiv;
-      else if (node.op == "%")
-        op = isUnsigned ? OpCode::URem : OpCode::SRem;
-      else
-        op = OpCode::Add;
-
       currentBlock_->addInstruction(
           std::make_unique<BinaryInst>(op, reg, left, right));
     }
@@ -364,7 +398,7 @@ namespace zir
       {
         valueStack_.push(std::make_shared<Constant>(
             std::to_string(value),
-            std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int)));
+            types_->getPrimitive(zir::TypeKind::Int)));
         return;
       }
     }
@@ -397,7 +431,7 @@ namespace zir
   void BoundIRGenerator::visit(sema::BoundStructLiteral &node)
   {
     auto recordType = std::static_pointer_cast<zir::RecordType>(node.type);
-    auto allocaReg = createRegister(std::make_shared<PointerType>(recordType));
+    auto allocaReg = createRegister(types_->getPointer(recordType));
     currentBlock_->addInstruction(std::make_unique<AllocaInst>(allocaReg, recordType));
 
     for (const auto &fieldInit : node.fields)
@@ -418,7 +452,7 @@ namespace zir
       auto val = std::move(valueStack_.top());
       valueStack_.pop();
 
-      auto fieldAddr = createRegister(std::make_shared<PointerType>(fields[fieldIndex].type));
+      auto fieldAddr = createRegister(types_->getPointer(fields[fieldIndex].type));
       currentBlock_->addInstruction(std::make_unique<GetElementPtrInst>(fieldAddr, allocaReg, fieldIndex));
       currentBlock_->addInstruction(std::make_unique<StoreInst>(val, fieldAddr));
     }
@@ -596,7 +630,7 @@ namespace zir
         } catch (...) {}
     }
 
-    auto ptr = createRegister(std::make_shared<PointerType>(node.type));
+    auto ptr = createRegister(types_->getPointer(node.type));
     currentBlock_->addInstruction(std::make_unique<GetElementPtrInst>(ptr, left, idx));
     
     auto res = createRegister(node.type);
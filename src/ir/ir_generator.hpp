@@ -42,6 +42,7 @@ namespace zir
 
   private:
     std::unique_ptr<Module> module_;
+    std::shared_ptr<TypeContext> types_;
     Function *currentFunction_ = nullptr;
     BasicBlock *currentBlock_ = nullptr;
 
@@ -1,4 +1,5 @@
 #pragma once
+#include "../utils/identifier.hpp"
 #include <memory>
 #include <string>
 #include <vector>
@@ -113,42 +114,42 @@ public:
 
 class RecordType : public Type {
   struct Field {
-    std::string name;
+    zap::Identifier name;
     std::shared_ptr<Type> type;
   };
 
-  std::string name;
+  zap::Identifier name;
   std::vector<Field> fields;
 
 public:
-  RecordType(std::string n) : name(std::move(n)) {}
+  RecordType(zap::Identifier n) : name(n) {}
   TypeKind getKind() const override { return TypeKind::Record; }
   std::string toString() const override { return "%" + name; }
   bool isReferenceType() const override { return true; }
 
-  void addField(std::string n, std::shared_ptr<Type> t) {
-    fields.push_back({std::move(n), std::move(t)});
+  void addField(zap::Identifier n, std::shared_ptr<Type> t) {
+    fields.push_back({n, std::move(t)});
   }
 
   const std::vector<Field> &getFields() const { return fields; }
-  const std::string &getName() const { return name; }
+  zap::Identifier getName() const { return name; }
 };
 
 class EnumType : public Type {
-  std::string name;
-  std::vector<std::string> variants;
+  zap::Identifier name;
+  std::vector<zap::Identifier> variants;
 
 public:
-  EnumType(std::string n, std::vector<std::string> v)
-      : name(std::move(n)), variants(std::move(v)) {}
+  EnumType(zap::Identifier n, std::vector<zap::Identifier> v)
+      : name(n), variants(std::move(v)) {}
   TypeKind getKind() const override { return TypeKind::Enum; }
   std::string toString() const override { return "enum " + name; }
   bool isReferenceType() const override { return false; }
 
-  const std::vector<std::string> &getVariants() const { return variants; }
-  const std::string &getName() const { return name; }
+  const std::vector<zap::Identifier> &getVariants() const { return variants; }
+  zap::Identifier getName() const { return name; }
 
-  int getVariantIndex(const std::string &variantName) const {
+  int getVariantIndex(zap::Identifier variantName) const {
     for (size_t i = 0; i < variants.size(); ++i) {
       if (variants[i] == variantName) {
         return static_cast<int>(i);
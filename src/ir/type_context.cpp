@@ -0,0 +1,41 @@
+#include "type_context.hpp"
+
+namespace zir {
+
+TypeContext::TypeContext() {
+  for (size_t i = 0; i < primitives.size(); ++i) {
+    primitives[i] = std::make_shared<PrimitiveType>(static_cast<TypeKind>(i));
+  }
+  string = getRecord("String");
+}
+
+std::shared_ptr<RecordType> TypeContext::getRecord(zap::Identifier name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &record = records[name];
+  if (!record) {
+    record = std::make_shared<RecordType>(name);
+  }
+  return record;
+}
+
+std::shared_ptr<ArrayType>
+TypeContext::getArray(const std::shared_ptr<Type> &base, size_t size) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &array = arrays[{base.get(), size}];
+  if (!array) {
+    array = std::make_shared<ArrayType>(base, size);
+  }
+  return array;
+}
+
+std::shared_ptr<PointerType>
+TypeContext::getPointer(const std::shared_ptr<Type> &base) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &pointer = pointers[base.get()];
+  if (!pointer) {
+    pointer = std::make_shared<PointerType>(base);
+  }
+  return pointer;
+}
+
+} // namespace zir
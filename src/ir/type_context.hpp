@@ -0,0 +1,62 @@
+#pragma once
+#include "../utils/identifier.hpp"
+#include "type.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace zir {
+
+/// @brief Owns the types of a compilation unit and hands out a single
+/// instance of each: one per primitive kind, one record per name and one
+/// array or pointer per base type (and size). Equal types are then the same
+/// object, so they can be compared and used as map keys by pointer.
+///
+/// Enums are created by their declarations, each one is a distinct type.
+/// Safe to use from multiple threads at once.
+class TypeContext {
+public:
+  TypeContext();
+  TypeContext(const TypeContext &) = delete;
+  TypeContext &operator=(const TypeContext &) = delete;
+
+  /// @brief Returns the type of a primitive kind, Void to Char.
+  const std::shared_ptr<Type> &getPrimitive(TypeKind kind) const {
+    return primitives[static_cast<size_t>(kind)];
+  }
+
+  /// @brief Returns the builtin String record.
+  const std::shared_ptr<RecordType> &getString() const { return string; }
+
+  /// @brief Returns the record named name, created on first use. Its
+  /// fields are added by the declaration of the record.
+  std::shared_ptr<RecordType> getRecord(zap::Identifier name);
+
+  std::shared_ptr<ArrayType> getArray(const std::shared_ptr<Type> &base,
+                                      size_t size);
+
+  std::shared_ptr<PointerType> getPointer(const std::shared_ptr<Type> &base);
+
+private:
+  struct ArrayKeyHash {
+    size_t operator()(const std::pair<const Type *, size_t> &key) const {
+      return std::hash<const Type *>()(key.first) ^ (key.second * 31);
+    }
+  };
+
+  std::array<std::shared_ptr<Type>, static_cast<size_t>(TypeKind::Char) + 1>
+      primitives;
+  std::shared_ptr<RecordType> string;
+
+  std::mutex mutex;
+  std::unordered_map<zap::Identifier, std::shared_ptr<RecordType>> records;
+  std::unordered_map<std::pair<const Type *, size_t>,
+                     std::shared_ptr<ArrayType>, ArrayKeyHash>
+      arrays;
+  std::unordered_map<const Type *, std::shared_ptr<PointerType>> pointers;
+};
+
+} // namespace zir
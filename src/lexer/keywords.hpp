@@ -0,0 +1,123 @@
+#pragma once
+#include "../token/token.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/// @brief Keyword recognition through a perfect hash table that is built at
+/// compile time from 'LIST'.
+namespace keywords {
+
+struct Keyword {
+  std::string_view text;
+  TokenType type;
+};
+
+/// @brief Every keyword and the token it's lexed as.
+inline constexpr Keyword LIST[] = {
+    {"if", TokenType::IF},         {"else", TokenType::ELSE},
+    {"while", TokenType::WHILE},   {"for", TokenType::FOR},
+    {"return", TokenType::RETURN}, {"ret", TokenType::RETURN},
+    {"true", TokenType::BOOL},     {"false", TokenType::BOOL},
+    {"fun", TokenType::FUN},       {"import", TokenType::IMPORT},
+    {"match", TokenType::MATCH},   {"var", TokenType::VAR},
+    {"ext", TokenType::EXTERN},    {"module", TokenType::MODULE},
+    {"pub", TokenType::PUB},       {"priv", TokenType::PRIV},
+    {"record", TokenType::RECORD}, {"impl", TokenType::IMPL},
+    {"static", TokenType::STATIC}, {"enum", TokenType::ENUM},
+    {"struct", TokenType::STRUCT}, {"break", TokenType::BREAK},
+    {"continue", TokenType::CONTINUE}, {"val", TokenType::VAL},
+    {"global", TokenType::GLOBAL}, {"const", TokenType::CONST},
+};
+
+/// @brief Number of slots in the table, a power of two.
+constexpr size_t TABLE_SIZE = 64;
+
+/// @brief Hashes a non-empty word from its first and last character and its
+/// length.
+struct Hash {
+  uint32_t first;
+  uint32_t last;
+
+  constexpr size_t operator()(std::string_view word) const noexcept {
+    return (static_cast<uint8_t>(word.front()) * first +
+            static_cast<uint8_t>(word.back()) * last + word.size()) &
+           (TABLE_SIZE - 1);
+  }
+};
+
+/// @brief Returns whether no two keywords share a slot under hash.
+constexpr bool isPerfect(Hash hash) {
+  std::array<bool, TABLE_SIZE> used{};
+  for (const Keyword &keyword : LIST) {
+    size_t slot = hash(keyword.text);
+    if (used[slot]) {
+      return false;
+    }
+    used[slot] = true;
+  }
+  return true;
+}
+
+/// @brief Searches for multipliers that make the hash perfect.
+constexpr Hash findHash() {
+  for (uint32_t first = 1; first < TABLE_SIZE; ++first) {
+    for (uint32_t last = 1; last < TABLE_SIZE; ++last) {
+      if (isPerfect({first, last})) {
+        return {first, last};
+      }
+    }
+  }
+  return {0, 0};
+}
+
+inline constexpr Hash HASH = findHash();
+static_assert(HASH.first != 0,
+              "no perfect hash for the keywords, increase TABLE_SIZE");
+
+constexpr std::array<Keyword, TABLE_SIZE> buildTable() {
+  std::array<Keyword, TABLE_SIZE> table{};
+  for (const Keyword &keyword : LIST) {
+    table[HASH(keyword.text)] = keyword;
+  }
+  return table;
+}
+
+inline constexpr std::array<Keyword, TABLE_SIZE> TABLE = buildTable();
+
+constexpr size_t minLength() {
+  size_t len = LIST[0].text.size();
+  for (const Keyword &keyword : LIST) {
+    len = keyword.text.size() < len ? keyword.text.size() : len;
+  }
+  return len;
+}
+
+constexpr size_t maxLength() {
+  size_t len = 0;
+  for (const Keyword &keyword : LIST) {
+    len = keyword.text.size() > len ? keyword.text.size() : len;
+  }
+  return len;
+}
+
+inline constexpr size_t MIN_LENGTH = minLength();
+inline constexpr size_t MAX_LENGTH = maxLength();
+
+/// @brief Classifies an identifier with one hash and one comparison.
+/// @return The keyword's token type, or 'TokenType::ID'.
+constexpr TokenType lookup(std::string_view word) noexcept {
+  if (word.size() < MIN_LENGTH || word.size() > MAX_LENGTH) {
+    return TokenType::ID;
+  }
+  const Keyword &keyword = TABLE[HASH(word)];
+  return keyword.text == word ? keyword.type : TokenType::ID;
+}
+
+static_assert(lookup("fun") == TokenType::FUN &&
+                  lookup("ret") == TokenType::RETURN &&
+                  lookup("fn") == TokenType::ID,
+              "keyword table is broken");
+
+} // namespace keywords
@@ -1,453 +1,320 @@
 #include "lexer.hpp"
+#include "keywords.hpp"
+#include "scan.hpp"
+#include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <cstdlib>
 
-std::vector<Token> Lexer::tokenize(const std::string &input) {
-  std::vector<Token> tokens;
-  _pos = 0;
-  _line = 1;
-  _column = 1;
+void Lexer::reset(std::string_view input, size_t begin) noexcept {
+  _pos = begin;
   _input = input;
+}
 
+std::vector<Token> Lexer::tokenize(std::string_view input) {
+  reset(input);
+  std::vector<Token> tokens;
+  Token token;
+  while (next(token)) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+bool Lexer::next(Token &token) {
   while (!isAtEnd()) {
     char _cur = _input[_pos];
     size_t startPos = _pos;
-    size_t startLine = _line;
-    size_t startColumn = _column;
 
     if (_cur == '(') {
-      tokens.emplace_back(TokenType::LPAREN, "(", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::LPAREN, "(", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == ')') {
-      tokens.emplace_back(TokenType::RPAREN, ")", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::RPAREN, ")", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '{') {
-      tokens.emplace_back(TokenType::LBRACE, "{", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::LBRACE, "{", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '}') {
-      tokens.emplace_back(TokenType::RBRACE, "}", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::RBRACE, "}", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '[') {
-      tokens.emplace_back(TokenType::SQUARE_LBRACE, "[", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::SQUARE_LBRACE, "[", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == ']') {
-      tokens.emplace_back(TokenType::SQUARE_RBRACE, "]", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::SQUARE_RBRACE, "]", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == ';') {
-      tokens.emplace_back(TokenType::SEMICOLON, ";", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::SEMICOLON, ";", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == ',') {
-      tokens.emplace_back(TokenType::COMMA, ",", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::COMMA, ",", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == ':') {
       if (Peek2() == ':') {
-        tokens.emplace_back(TokenType::DOUBLECOLON, "::", startLine,
-                            startColumn, startPos, 2);
+        token = Token(TokenType::DOUBLECOLON, "::", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::COLON, ":", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::COLON, ":", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '.') {
       if (Peek2() == '.' && Peek3() == '.') {
-        tokens.emplace_back(TokenType::ELLIPSIS, "...", startLine, startColumn,
-                            startPos, 3);
+        token = Token(TokenType::ELLIPSIS, "...", startPos, 3);
         _pos += 3;
-        _column += 3;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::DOT, ".", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::DOT, ".", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '?') {
-      tokens.emplace_back(TokenType::QUESTION, "?", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::QUESTION, "?", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '+') {
-      tokens.emplace_back(TokenType::PLUS, "+", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::PLUS, "+", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '*') {
-      tokens.emplace_back(TokenType::MULTIPLY, "*", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::MULTIPLY, "*", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '-') {
       if (Peek2() == '>') {
-        tokens.emplace_back(TokenType::ARROW, "->", startLine, startColumn,
-                            startPos, 2);
+        token = Token(TokenType::ARROW, "->", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       }
-      tokens.emplace_back(TokenType::MINUS, "-", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::MINUS, "-", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '/') {
       if (Peek2() == '/') {
-        while (!isAtEnd() && _input[_pos] != '\n') {
-          ++_pos;
-        }
+        _pos = scan::findLineEnd(_input, _pos + 2);
         continue;
       } else {
-        tokens.emplace_back(TokenType::DIVIDE, "/", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::DIVIDE, "/", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '%') {
-      tokens.emplace_back(TokenType::MODULO, "%", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::MODULO, "%", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '^') {
-      tokens.emplace_back(TokenType::POW, "^", startLine, startColumn, startPos,
-                          1);
+      token = Token(TokenType::POW, "^", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '&') {
       if (Peek2() == '&') {
-        tokens.emplace_back(TokenType::AND, "&&", startLine, startColumn,
-                            startPos, 2);
+        token = Token(TokenType::AND, "&&", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::REFERENCE, "&", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::REFERENCE, "&", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '|') {
       if (Peek2() == '|') {
-        tokens.emplace_back(TokenType::OR, "||", startLine, startColumn,
-                            startPos, 2);
+        token = Token(TokenType::OR, "||", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::BIT_OR, "|", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::BIT_OR, "|", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '~') {
-      tokens.emplace_back(TokenType::CONCAT, "~", startLine, startColumn,
-                          startPos, 1);
+      token = Token(TokenType::CONCAT, "~", startPos, 1);
       ++_pos;
-      ++_column;
-      continue;
+      return true;
     } else if (_cur == '=') {
       if (Peek2() == '=') {
-        tokens.emplace_back(TokenType::EQUAL, "==", startLine, startColumn,
-                            startPos, 2);
+        token = Token(TokenType::EQUAL, "==", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::ASSIGN, "=", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::ASSIGN, "=", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '!') {
       if (Peek2() == '=') {
-        tokens.emplace_back(TokenType::NOTEQUAL, "!=", startLine, startColumn,
-                            startPos, 2);
+        token = Token(TokenType::NOTEQUAL, "!=", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::NOT, "!", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::NOT, "!", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '<') {
       if (Peek2() == '=') {
-        tokens.emplace_back(TokenType::LESSEQUAL, "<=", startLine, startColumn,
-                            startPos, 2);
+        token = Token(TokenType::LESSEQUAL, "<=", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::LESS, "<", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::LESS, "<", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (_cur == '>') {
       if (Peek2() == '=') {
-        tokens.emplace_back(TokenType::GREATEREQUAL, ">=", startLine,
-                            startColumn, startPos, 2);
+        token = Token(TokenType::GREATEREQUAL, ">=", startPos, 2);
         _pos += 2;
-        _column += 2;
-        continue;
+        return true;
       } else {
-        tokens.emplace_back(TokenType::GREATER, ">", startLine, startColumn,
-                            startPos, 1);
+        token = Token(TokenType::GREATER, ">", startPos, 1);
         ++_pos;
-        ++_column;
-        continue;
+        return true;
       }
     } else if (std::isdigit(_cur)) {
-      std::string numStr;
+      // Numbers are parsed here, once, the token carries their value.
+      int base = 10;
+      if (_cur == '0' && (Peek2() == 'x' || Peek2() == 'X')) {
+        base = 16;
+        _pos += 2;
+      } else if (_cur == '0' && (Peek2() == 'b' || Peek2() == 'B')) {
+        base = 2;
+        _pos += 2;
+      }
+
+      size_t digitsStart = _pos;
       bool isFloat = false;
-      while (!isAtEnd() && std::isdigit(_input[_pos])) {
-        numStr += _input[_pos++];
-        _column++;
+      if (base == 16) {
+        while (!isAtEnd() && std::isxdigit(_input[_pos])) {
+          ++_pos;
+        }
+      } else {
+        while (!isAtEnd() && std::isdigit(_input[_pos])) {
+          ++_pos;
+        }
       }
-      if (!isAtEnd() && _input[_pos] == '.') {
+      if (base == 10 && !isAtEnd() && _input[_pos] == '.') {
         isFloat = true;
-        numStr += _input[_pos++];
-        _column++;
+        ++_pos;
         while (!isAtEnd() && std::isdigit(_input[_pos])) {
-          numStr += _input[_pos++];
-          _column++;
+          ++_pos;
         }
       }
-      size_t len = numStr.length();
+      size_t len = _pos - startPos;
+      std::string_view numStr = _input.substr(startPos, len);
+      const char *first = _input.data() + digitsStart;
+      const char *last = _input.data() + _pos;
+
       if (isFloat) {
-        tokens.emplace_back(TokenType::FLOAT, numStr, startLine, startColumn,
-                            startPos, len);
+        token = Token(TokenType::FLOAT, numStr, startPos, len);
+        auto result = std::from_chars(first, last, token.real);
+        if (result.ec != std::errc() || result.ptr != last) {
+          error(SourceSpan(startPos, len), "Invalid float literal");
+        }
       } else {
-        tokens.emplace_back(TokenType::INTEGER, numStr, startLine, startColumn,
-                            startPos, len);
+        token = Token(TokenType::INTEGER, numStr, startPos, len);
+        auto result = std::from_chars(first, last, token.integer, base);
+        if (first == last) {
+          error(SourceSpan(startPos, len), "Expected digits after '" +
+                                               std::string(numStr) + "'");
+        } else if (result.ec == std::errc::result_out_of_range) {
+          error(SourceSpan(startPos, len),
+                "Integer literal '" + std::string(numStr) +
+                    "' doesn't fit in 64 bits");
+        } else if (result.ptr != last) {
+          error(SourceSpan(startPos, len),
+                "Invalid digit in binary literal '" + std::string(numStr) +
+                    "'");
+        }
       }
-      continue;
+      return true;
     } else if (std::isalpha(_cur) || _cur == '_') {
-      std::string identStr;
-      while (!isAtEnd() &&
-             (std::isalnum(_input[_pos]) || _input[_pos] == '_')) {
-        identStr += _input[_pos++];
-        _column++;
-      }
-      size_t len = identStr.length();
+      _pos = scan::skipIdentifier(_input, _pos + 1);
+      size_t len = _pos - startPos;
+      std::string_view identStr = _input.substr(startPos, len);
 
-      TokenType type = TokenType::ID;
-      if (identStr == "if")
-        type = TokenType::IF;
-      else if (identStr == "else")
-        type = TokenType::ELSE;
-      else if (identStr == "while")
-        type = TokenType::WHILE;
-      else if (identStr == "for")
-        type = TokenType::FOR;
-      else if (identStr == "return" || identStr == "ret")
-        type = TokenType::RETURN;
-      else if (identStr == "true" || identStr == "false")
-        type = TokenType::BOOL;
-      else if (identStr == "fun")
-        type = TokenType::FUN;
-      else if (identStr == "import")
-        type = TokenType::IMPORT;
-      else if (identStr == "match")
-        type = TokenType::MATCH;
-      else if (identStr == "var")
-        type = TokenType::VAR;
-      else if (identStr == "ext")
-        type = TokenType::EXTERN;
-      else if (identStr == "module")
-        type = TokenType::MODULE;
-      else if (identStr == "pub")
-        type = TokenType::PUB;
-      else if (identStr == "priv")
-        type = TokenType::PRIV;
-      else if (identStr == "record")
-        type = TokenType::RECORD;
-      else if (identStr == "impl")
-        type = TokenType::IMPL;
-      else if (identStr == "static")
-        type = TokenType::STATIC;
-      else if (identStr == "enum")
-        type = TokenType::ENUM;
-      else if (identStr == "struct")
-        type = TokenType::STRUCT;
-      else if (identStr == "break")
-        type = TokenType::BREAK;
-      else if (identStr == "continue")
-        type = TokenType::CONTINUE;
-      else if (identStr == "val")
-        type = TokenType::VAL;
-      else if (identStr == "global")
-        type = TokenType::GLOBAL;
-      else if (identStr == "const")
-        type = TokenType::CONST;
-
-      tokens.emplace_back(type, identStr, startLine, startColumn, startPos,
-                          len);
-      continue;
-    } else if (std::isspace(_cur)) {
-      if (_cur == '\n') {
-        ++_line;
-        _column = 1;
-      } else {
-        ++_column;
+      TokenType type = keywords::lookup(identStr);
+      token = Token(type, identStr, startPos, len);
+      if (type == TokenType::ID) {
+        token.ident = zap::Identifier(identStr);
       }
-      ++_pos;
+      return true;
+    } else if (std::isspace(_cur)) {
+      _pos = scan::skipWhitespace(_input, _pos + 1);
       continue;
     } else if (_cur == '"') {
-      std::string strVal;
+      // Escape sequences are left for the parser, the token only points at
+      // the text between the quotes.
       size_t strStart = _pos;
       ++_pos;
-      _column++;
-
-      while (!isAtEnd() && _input[_pos] != '"') {
-        if (_input[_pos] == '\n') {
-          ++_line;
-          _column = 1;
-        } else {
-          _column++;
-        }
-
-        if (_input[_pos] == '\\') {
-          ++_pos;
-          if (isAtEnd())
-            break;
 
-          switch (_input[_pos]) {
-          case 'n':
-            strVal += '\n';
-            break;
-          case 't':
-            strVal += '\t';
-            break;
-          case 'r':
-            strVal += '\r';
-            break;
-          case '\\':
-            strVal += '\\';
-            break;
-          case '"':
-            strVal += '"';
-            break;
-          case '0':
-            strVal += '\0';
-            break;
-          case 'w':
-            strVal += ' ';
-            break;
-          default:
-            strVal += _input[_pos];
-            break;
-          }
-        } else {
-          strVal += _input[_pos];
-        }
-        ++_pos;
+      while (true) {
+        _pos = scan::findQuoteOrEscape(_input, _pos);
+        if (isAtEnd() || _input[_pos] == '"')
+          break;
+        // Skip the escaped character so an escaped quote doesn't end the
+        // literal.
+        _pos = std::min(_pos + 2, _input.size());
       }
 
       if (!isAtEnd() && _input[_pos] == '"') {
+        std::string_view strVal =
+            _input.substr(strStart + 1, _pos - strStart - 1);
         ++_pos;
-        _column++;
         size_t len = _pos - strStart;
-        tokens.emplace_back(TokenType::STRING, strVal, startLine, startColumn,
-                            startPos, len);
-        continue;
+        token = Token(TokenType::STRING, strVal, startPos, len);
+        return true;
       } else {
-        _diag.report(
-            SourceSpan(startLine, startColumn, strStart, _pos - strStart),
-            zap::DiagnosticLevel::Error, "Unterminated string literal");
-        exit(EXIT_FAILURE);
+        error(SourceSpan(strStart, _pos - strStart),
+              "Unterminated string literal");
+        continue;
       }
     } else if (_cur == '\'') {
-      // char literal
-      std::string charVal;
+      // char literal, escape sequences are left for the parser
       size_t charStart = _pos;
       ++_pos;
-      _column++;
       if (isAtEnd()) {
-        _diag.report(SourceSpan(startLine, startColumn, charStart, 1), zap::DiagnosticLevel::Error,
-                     "Unterminated char literal");
-        exit(EXIT_FAILURE);
+        error(SourceSpan(charStart, 1), "Unterminated char literal");
+        continue;
       }
       if (_input[_pos] == '\\') {
         ++_pos;
         if (isAtEnd()) {
-          _diag.report(SourceSpan(startLine, startColumn, charStart, 1), zap::DiagnosticLevel::Error,
-                       "Unterminated char literal");
-          exit(EXIT_FAILURE);
+          error(SourceSpan(charStart, 1), "Unterminated char literal");
+          continue;
         }
-        switch (_input[_pos]) {
-        case 'n': charVal += '\n'; break;
-        case 't': charVal += '\t'; break;
-        case 'r': charVal += '\r'; break;
-        case '\\': charVal += '\\'; break;
-        case '\'': charVal += '\''; break;
-        case '0': charVal += '\0'; break;
-        default: charVal += _input[_pos]; break;
-        }
-      } else {
-        charVal += _input[_pos];
       }
       ++_pos;
-      _column++;
       if (isAtEnd() || _input[_pos] != '\'') {
-        _diag.report(SourceSpan(startLine, startColumn, charStart, 1), zap::DiagnosticLevel::Error,
-                     "Unterminated char literal");
-        exit(EXIT_FAILURE);
+        error(SourceSpan(charStart, 1), "Unterminated char literal");
+        continue;
       }
+      std::string_view charVal =
+          _input.substr(charStart + 1, _pos - charStart - 1);
       ++_pos;
-      _column++;
-      tokens.emplace_back(TokenType::CHAR, charVal, startLine, startColumn,
-                          startPos, 3);
-      continue;
+      token = Token(TokenType::CHAR, charVal, startPos, _pos - charStart);
+      return true;
     } else {
-      _diag.report(SourceSpan(startLine, startColumn, _pos, 1),
-                   zap::DiagnosticLevel::Error,
-                   "Unexpected character '" + std::string(1, _cur) + "'");
+      error(SourceSpan(_pos, 1),
+            "Unexpected character '" + std::string(1, _cur) + "'");
       _pos++;
-      _column++;
     }
   }
-  return tokens;
+  return false;
+}
+
+void Lexer::error(SourceSpan span, const std::string &message) {
+  _hadErrors = true;
+  _diag.report(span, zap::DiagnosticLevel::Error, message);
 }
 
 char Lexer::Peek2() {
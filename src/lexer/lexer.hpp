@@ -2,21 +2,38 @@
 #include "../token/token.hpp"
 #include "../utils/diagnostics.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Lexer {
 public:
   zap::DiagnosticEngine &_diag;
-  size_t _pos;
-  size_t _line;
-  size_t _column;
-  std::string _input;
+  size_t _pos = 0;
+  std::string_view _input;
+  bool _hadErrors = false;
 
-  Lexer(zap::DiagnosticEngine &diag) noexcept(std::is_nothrow_default_constructible<std::string>::value) 
-      : _diag(diag) {}
+  Lexer(zap::DiagnosticEngine &diag) noexcept : _diag(diag) {}
   ~Lexer() noexcept {}
-  std::vector<Token> tokenize(const std::string &input);
+
+  /// @brief Splits the input into tokens.
+  /// The tokens point into input, it has to outlive them.
+  std::vector<Token> tokenize(std::string_view input);
+
+  /// @brief Starts lexing input at offset begin, for pulling tokens one by
+  /// one with next(). The tokens point into input, it has to outlive them.
+  void reset(std::string_view input, size_t begin = 0) noexcept;
+
+  /// @brief Lexes the next token of the input.
+  /// @return False once the end of the input is reached.
+  bool next(Token &token);
+
+  /// @brief Returns whether an error has been reported.
+  bool hadErrors() const noexcept { return _hadErrors; }
+
   char Peek2();
   char Peek3();
   bool isAtEnd() const noexcept;
+
+private:
+  void error(SourceSpan span, const std::string &message);
 };
@@ -0,0 +1,213 @@
+#include "scan.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) &&      \
+    defined(__GNUC__)
+#define ZAP_SCAN_X86 1
+#include <immintrin.h>
+#define ZAP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ZAP_SCAN_X86 0
+#endif
+
+namespace scan {
+namespace {
+
+enum class Kind { WHITESPACE, IDENTIFIER, LINE, STRING };
+
+enum class Isa { SCALAR, SSE2, AVX2 };
+
+/// @brief Returns whether c continues a run of kind K.
+template <Kind K> inline bool continuesRun(unsigned char c) noexcept {
+  if constexpr (K == Kind::WHITESPACE) {
+    return c == ' ' || static_cast<unsigned>(c - '\t') <= '\r' - '\t';
+  } else if constexpr (K == Kind::IDENTIFIER) {
+    return static_cast<unsigned>((c | 0x20) - 'a') <= 'z' - 'a' ||
+           static_cast<unsigned>(c - '0') <= 9 || c == '_';
+  } else if constexpr (K == Kind::LINE) {
+    return c != '\n';
+  } else {
+    return c != '"' && c != '\\';
+  }
+}
+
+template <Kind K>
+inline size_t runScalar(std::string_view input, size_t pos) noexcept {
+  while (pos < input.size() &&
+         continuesRun<K>(static_cast<unsigned char>(input[pos]))) {
+    ++pos;
+  }
+  return pos;
+}
+
+#if ZAP_SCAN_X86
+
+// Unsigned range checks through min_epu8, since SSE2 and AVX2 only have
+// signed byte comparisons: (v - lo) <= span.
+
+inline __m128i inRange128(__m128i v, char lo, char span) noexcept {
+  __m128i x = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+  return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(span)), x);
+}
+
+/// @brief Bit i is set if byte i ends the run.
+template <Kind K> inline uint32_t stopMask128(__m128i v) noexcept {
+  if constexpr (K == Kind::WHITESPACE) {
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 inRange128(v, '\t', '\r' - '\t'));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(space)) & 0xFFFF;
+  } else if constexpr (K == Kind::IDENTIFIER) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i ident = _mm_or_si128(
+        _mm_or_si128(inRange128(lower, 'a', 'z' - 'a'),
+                     inRange128(v, '0', 9)),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(ident)) & 0xFFFF;
+  } else if constexpr (K == Kind::LINE) {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+  } else {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))));
+  }
+}
+
+template <Kind K>
+inline size_t runSSE2(std::string_view input, size_t pos) noexcept {
+  const char *data = input.data();
+  while (pos + 16 <= input.size()) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    uint32_t stop = stopMask128<K>(v);
+    if (stop) {
+      return pos + __builtin_ctz(stop);
+    }
+    pos += 16;
+  }
+  return runScalar<K>(input, pos);
+}
+
+ZAP_TARGET_AVX2 inline __m256i inRange256(__m256i v, char lo,
+                                          char span) noexcept {
+  __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(span)), x);
+}
+
+template <Kind K>
+ZAP_TARGET_AVX2 inline uint32_t stopMask256(__m256i v) noexcept {
+  if constexpr (K == Kind::WHITESPACE) {
+    __m256i space =
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                        inRange256(v, '\t', '\r' - '\t'));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(space));
+  } else if constexpr (K == Kind::IDENTIFIER) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i ident = _mm256_or_si256(
+        _mm256_or_si256(inRange256(lower, 'a', 'z' - 'a'),
+                        inRange256(v, '0', 9)),
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(ident));
+  } else if constexpr (K == Kind::LINE) {
+    return static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+  } else {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')))));
+  }
+}
+
+template <Kind K>
+ZAP_TARGET_AVX2 size_t runAVX2(std::string_view input, size_t pos) noexcept {
+  const char *data = input.data();
+  while (pos + 32 <= input.size()) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    uint32_t stop = stopMask256<K>(v);
+    if (stop) {
+      return pos + __builtin_ctz(stop);
+    }
+    pos += 32;
+  }
+  return runSSE2<K>(input, pos);
+}
+
+Isa detect() noexcept {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? Isa::AVX2 : Isa::SSE2;
+}
+
+#else
+
+Isa detect() noexcept { return Isa::SCALAR; }
+
+#endif
+
+Isa active = detect();
+
+template <Kind K> size_t run(std::string_view input, size_t pos) noexcept {
+  // Runs often end right away (a single space, a one letter name), don't
+  // load a vector for them.
+  if (pos < input.size() &&
+      !continuesRun<K>(static_cast<unsigned char>(input[pos]))) {
+    return pos;
+  }
+#if ZAP_SCAN_X86
+  switch (active) {
+  case Isa::AVX2:
+    return runAVX2<K>(input, pos);
+  case Isa::SSE2:
+    return runSSE2<K>(input, pos);
+  case Isa::SCALAR:
+    break;
+  }
+#endif
+  return runScalar<K>(input, pos);
+}
+
+} // namespace
+
+size_t skipWhitespace(std::string_view input, size_t pos) noexcept {
+  return run<Kind::WHITESPACE>(input, pos);
+}
+
+size_t skipIdentifier(std::string_view input, size_t pos) noexcept {
+  return run<Kind::IDENTIFIER>(input, pos);
+}
+
+size_t findLineEnd(std::string_view input, size_t pos) noexcept {
+  return run<Kind::LINE>(input, pos);
+}
+
+size_t findQuoteOrEscape(std::string_view input, size_t pos) noexcept {
+  return run<Kind::STRING>(input, pos);
+}
+
+const char *implementation() noexcept {
+  switch (active) {
+  case Isa::AVX2:
+    return "avx2";
+  case Isa::SSE2:
+    return "sse2";
+  case Isa::SCALAR:
+    break;
+  }
+  return "scalar";
+}
+
+bool useImplementation(const char *name) noexcept {
+  Isa best = detect();
+  if (std::strcmp(name, "scalar") == 0) {
+    active = Isa::SCALAR;
+  } else if (std::strcmp(name, "sse2") == 0 && best != Isa::SCALAR) {
+    active = Isa::SSE2;
+  } else if (std::strcmp(name, "avx2") == 0 && best == Isa::AVX2) {
+    active = Isa::AVX2;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace scan
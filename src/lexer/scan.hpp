@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+/// @brief Vectorized scanning for the lexer's long runs. Every function
+/// starts at pos and returns the position of the first character that
+/// ends the run, or input.size(). AVX2 or SSE2 is used when the CPU has it
+/// (checked once at runtime), a scalar loop otherwise.
+namespace scan {
+
+/// @brief Skips ' ', '\\t', '\\n', '\\v', '\\f' and '\\r'.
+size_t skipWhitespace(std::string_view input, size_t pos) noexcept;
+
+/// @brief Skips [A-Za-z0-9_].
+size_t skipIdentifier(std::string_view input, size_t pos) noexcept;
+
+/// @brief Finds the next '\\n', e.g. the end of a comment.
+size_t findLineEnd(std::string_view input, size_t pos) noexcept;
+
+/// @brief Finds the next '"' or '\\' inside of a string literal.
+size_t findQuoteOrEscape(std::string_view input, size_t pos) noexcept;
+
+/// @brief Name of the implementation in use ("avx2", "sse2" or "scalar").
+const char *implementation() noexcept;
+
+/// @brief Switches to another implementation, for benchmarks and tests.
+/// Must not be called while a lexer is running.
+/// @return False if the name is unknown or the CPU doesn't support it.
+bool useImplementation(const char *name) noexcept;
+
+} // namespace scan
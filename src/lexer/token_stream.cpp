@@ -0,0 +1,50 @@
+#include "token_stream.hpp"
+#include <cassert>
+
+TokenStream::TokenStream(Lexer &lexer, std::string_view input, size_t begin)
+    : _lexer(lexer) {
+  _lexer.reset(input, begin);
+}
+
+bool TokenStream::fill(size_t count) {
+  assert(count <= LOOKAHEAD && "looking too far ahead");
+
+  while (_count < count && !_exhausted) {
+    Token &slot = _ring[(_head + _count) % LOOKAHEAD];
+    if (!_lexer.next(slot)) {
+      _exhausted = true;
+      break;
+    }
+
+    if (_lexer.hadErrors()) {
+      // Report the remaining lexer errors, but hand out no more tokens.
+      Token ignored;
+      while (_lexer.next(ignored)) {
+      }
+      _exhausted = true;
+      break;
+    }
+
+    _end = Token(TokenType::SEMICOLON, "",
+                 SourceSpan(slot.span.offset + slot.span.length, 0));
+    ++_count;
+  }
+  return _count >= count;
+}
+
+const Token &TokenStream::peek(size_t offset) {
+  if (!fill(offset + 1)) {
+    return _end;
+  }
+  return _ring[(_head + offset) % LOOKAHEAD];
+}
+
+Token TokenStream::advance() {
+  if (!fill(1)) {
+    return _end;
+  }
+  _previous = _ring[_head];
+  _head = (_head + 1) % LOOKAHEAD;
+  --_count;
+  return _previous;
+}
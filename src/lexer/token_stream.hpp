@@ -0,0 +1,56 @@
+#pragma once
+#include "../token/token.hpp"
+#include "lexer.hpp"
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+/// @brief Pulls tokens from a lexer on demand, so only a few of them are
+/// ever alive at once, no matter how big the file is.
+///
+/// At the first lexer error, the rest of the input is still lexed so every
+/// lexer error gets reported, but the stream ends there: parsing a broken
+/// token stream only produces follow-up errors.
+class TokenStream {
+public:
+  /// @brief How far ahead peek() can look, a power of two.
+  static constexpr size_t LOOKAHEAD = 8;
+
+  /// @brief The input has to outlive the stream and its tokens. Lexing
+  /// starts at offset begin, so a part of a file can be streamed on its own
+  /// while the spans stay relative to the whole file.
+  TokenStream(Lexer &lexer, std::string_view input, size_t begin = 0);
+
+  /// @brief Returns the token offset tokens ahead (less than LOOKAHEAD).
+  /// Past the end it's an empty token right after the last one.
+  const Token &peek(size_t offset = 0);
+
+  /// @brief Consumes the current token.
+  /// @return The consumed token, the end token if there is none.
+  Token advance();
+
+  /// @brief Returns the last consumed token.
+  const Token &previous() const noexcept { return _previous; }
+
+  /// @brief Returns whether all tokens have been consumed.
+  bool isAtEnd() { return !fill(1); }
+
+  /// @brief Returns the input the tokens are lexed from.
+  std::string_view input() const noexcept { return _lexer._input; }
+
+  /// @brief Returns whether the lexer reported an error.
+  bool hadErrors() const noexcept { return _lexer.hadErrors(); }
+
+private:
+  Lexer &_lexer;
+  std::array<Token, LOOKAHEAD> _ring;
+  size_t _head = 0;  // Index of the current token in _ring.
+  size_t _count = 0; // Number of tokens lexed ahead.
+  Token _previous;
+  Token _end;
+  bool _exhausted = false;
+
+  /// @brief Lexes until count tokens are buffered.
+  /// @return False if the input ends before.
+  bool fill(size_t count);
+};
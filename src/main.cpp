@@ -19,7 +19,18 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (zapcDriver.get_output_type() == zap::driver::output_type::JIT) {
+    int exit_code = 0;
+    if (zapcDriver.run(exit_code)) {
+      zapcDriver.cleanup();
+      return 1;
+    }
+    zapcDriver.cleanup();
+    return exit_code;
+  }
+
   if (zapcDriver.compile()) {
+    zapcDriver.cleanup();
     return 1;
   }
 
@@ -1,6 +1,6 @@
 #pragma once
-#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../ast/array_literal.hpp"
@@ -29,133 +29,151 @@
 #include "../ast/while_node.hpp"
 #include "../ast/break_node.hpp"
 #include "../ast/continue_node.hpp"
+#include "../ast/ext_decl.hpp"
+#include "../ast/struct_decl.hpp"
+#include "../ast/struct_literal.hpp"
+#include "../utils/arena.hpp"
 
 class AstBuilder {
 public:
-  std::unique_ptr<RootNode> makeRoot() { return std::make_unique<RootNode>(); }
+  /// @brief Nodes are allocated in arena and live as long as it.
+  explicit AstBuilder(zap::Arena &arena) noexcept : arena(arena) {}
 
-  std::unique_ptr<AssignNode> makeAssign(std::unique_ptr<ExpressionNode> target,
-                                         std::unique_ptr<ExpressionNode> expr) {
-    return std::make_unique<AssignNode>(std::move(target), std::move(expr));
+  RootNode *makeRoot() { return arena.make<RootNode>(); }
+
+  AssignNode *makeAssign(ExpressionNode *target, ExpressionNode *expr) {
+    return arena.make<AssignNode>(target, expr);
   }
 
-  std::unique_ptr<IndexAccessNode>
-  makeIndexAccess(std::unique_ptr<ExpressionNode> left,
-                  std::unique_ptr<ExpressionNode> index) {
-    return std::make_unique<IndexAccessNode>(std::move(left), std::move(index));
+  IndexAccessNode *makeIndexAccess(ExpressionNode *left,
+                                   ExpressionNode *index) {
+    return arena.make<IndexAccessNode>(left, index);
   }
 
-  std::unique_ptr<ArrayLiteralNode>
-  makeArrayLiteral(std::vector<std::unique_ptr<ExpressionNode>> elements) {
-    return std::make_unique<ArrayLiteralNode>(std::move(elements));
+  ArrayLiteralNode *
+  makeArrayLiteral(const std::vector<ExpressionNode *> &elements) {
+    return arena.make<ArrayLiteralNode>(arena.makeList(elements));
   }
 
-  std::unique_ptr<FunDecl> makeFunDecl(const std::string &name) {
-    auto f = std::make_unique<FunDecl>();
+  FunDecl *makeFunDecl(zap::Identifier name) {
+    auto f = arena.make<FunDecl>();
     f->name_ = name;
     return f;
   }
 
-  std::unique_ptr<MemberAccessNode> makeMemberAccess(std::unique_ptr<ExpressionNode> left,
-                                                    const std::string &member) {
-    return std::make_unique<MemberAccessNode>(std::move(left), member);
+  ExtDecl *makeExtDecl(zap::Identifier name) {
+    auto e = arena.make<ExtDecl>();
+    e->name_ = name;
+    return e;
+  }
+
+  MemberAccessNode *makeMemberAccess(ExpressionNode *left,
+                                     zap::Identifier member) {
+    return arena.make<MemberAccessNode>(left, member);
   }
 
-  std::unique_ptr<FunCall> makeFunCall(const std::string &name) {
-    auto f = std::make_unique<FunCall>();
+  FunCall *makeFunCall(zap::Identifier name) {
+    auto f = arena.make<FunCall>();
     f->funcName_ = name;
     return f;
   }
 
-  std::unique_ptr<BodyNode> makeBody() { return std::make_unique<BodyNode>(); }
+  BodyNode *makeBody() { return arena.make<BodyNode>(); }
+
+  IfNode *makeIf(ExpressionNode *condition, BodyNode *thenBody,
+                 BodyNode *elseBody) {
+    return arena.make<IfNode>(condition, thenBody, elseBody);
+  }
 
-  std::unique_ptr<IfNode> makeIf(std::unique_ptr<ExpressionNode> condition,
-                                 std::unique_ptr<BodyNode> thenBody,
-                                 std::unique_ptr<BodyNode> elseBody) {
-    return std::make_unique<IfNode>(std::move(condition), std::move(thenBody),
-                                    std::move(elseBody));
+  WhileNode *makeWhile(ExpressionNode *condition, BodyNode *body) {
+    return arena.make<WhileNode>(condition, body);
   }
 
-  std::unique_ptr<WhileNode>
-  makeWhile(std::unique_ptr<ExpressionNode> condition,
-            std::unique_ptr<BodyNode> body) {
-    return std::make_unique<WhileNode>(std::move(condition), std::move(body));
+  VarDecl *makeVarDecl(zap::Identifier name, TypeNode *type,
+                       ExpressionNode *init) {
+    return arena.make<VarDecl>(name, type, init);
   }
 
-  std::unique_ptr<VarDecl> makeVarDecl(const std::string &name,
-                                       std::unique_ptr<TypeNode> type,
-                                       std::unique_ptr<ExpressionNode> init) {
-    return std::make_unique<VarDecl>(name, std::move(type), std::move(init));
+  ConstDecl *makeConstDecl(zap::Identifier name, TypeNode *type,
+                           ExpressionNode *init) {
+    return arena.make<ConstDecl>(name, type, init);
   }
 
-  std::unique_ptr<ConstDecl> makeConstDecl(const std::string &name,
-                                         std::unique_ptr<TypeNode> type,
-                                         std::unique_ptr<ExpressionNode> init) {
-    return std::make_unique<ConstDecl>(name, std::move(type), std::move(init));
+  ReturnNode *makeReturn(ExpressionNode *value) {
+    return arena.make<ReturnNode>(value);
   }
 
-  std::unique_ptr<ReturnNode>
-  makeReturn(std::unique_ptr<ExpressionNode> value) {
-    return std::make_unique<ReturnNode>(std::move(value));
+  BreakNode *makeBreak() { return arena.make<BreakNode>(); }
+
+  ContinueNode *makeContinue() { return arena.make<ContinueNode>(); }
+
+  UnaryExpr *makeUnaryExpr(UnaryOp op, ExpressionNode *expr) {
+    return arena.make<UnaryExpr>(op, expr);
   }
 
-  std::unique_ptr<BreakNode> makeBreak() { return std::make_unique<BreakNode>(); }
+  BinExpr *makeBinExpr(ExpressionNode *left, BinaryOp op,
+                       ExpressionNode *right) {
+    return arena.make<BinExpr>(left, op, right);
+  }
 
-  std::unique_ptr<ContinueNode> makeContinue() { return std::make_unique<ContinueNode>(); }
+  ConstInt *makeConstInt(uint64_t value) {
+    return arena.make<ConstInt>(value);
+  }
 
-  std::unique_ptr<UnaryExpr>
-  makeUnaryExpr(const std::string &op, std::unique_ptr<ExpressionNode> expr) {
-    return std::make_unique<UnaryExpr>(op, std::move(expr));
+  ConstFloat *makeConstFloat(double value) {
+    return arena.make<ConstFloat>(value);
   }
 
-  std::unique_ptr<BinExpr> makeBinExpr(std::unique_ptr<ExpressionNode> left,
-                                       const std::string &op,
-                                       std::unique_ptr<ExpressionNode> right) {
-    return std::make_unique<BinExpr>(std::move(left), op, std::move(right));
+  ConstBool *makeConstBool(bool value) {
+    return arena.make<ConstBool>(value);
   }
 
-  std::unique_ptr<ConstInt> makeConstInt(int64_t value) {
-    return std::make_unique<ConstInt>(value);
+  ConstId *makeConstId(zap::Identifier value) {
+    return arena.make<ConstId>(value);
   }
 
-  std::unique_ptr<ConstFloat> makeConstFloat(double value) {
-    return std::make_unique<ConstFloat>(value);
+  ConstString *makeConstString(std::string value) {
+    return arena.make<ConstString>(std::move(value));
   }
 
-  std::unique_ptr<ConstBool> makeConstBool(bool value) {
-    return std::make_unique<ConstBool>(value);
+  ConstChar *makeConstChar(std::string value) {
+    return arena.make<ConstChar>(std::move(value));
   }
 
-  std::unique_ptr<ConstId> makeConstId(const std::string &value) {
-    return std::make_unique<ConstId>(value);
+  ParameterNode *makeParam(zap::Identifier name, TypeNode *type) {
+    return arena.make<ParameterNode>(name, type);
   }
 
-  std::unique_ptr<ConstString> makeConstString(const std::string &value) {
-    return std::make_unique<ConstString>(value);
+  TypeNode *makeType(zap::Identifier name) {
+    return arena.make<TypeNode>(name);
   }
 
-  std::unique_ptr<ConstChar> makeConstChar(const std::string &value) {
-    return std::make_unique<ConstChar>(value);
+  EnumDecl *makeEnumDecl(zap::Identifier name,
+                         const std::vector<zap::Identifier> &entries) {
+    return arena.make<EnumDecl>(name, arena.makeList(entries));
   }
 
-  std::unique_ptr<ParameterNode> makeParam(const std::string &name,
-                                           std::unique_ptr<TypeNode> type) {
-    return std::make_unique<ParameterNode>(name, std::move(type));
+  RecordDecl *makeRecordDecl(zap::Identifier name,
+                             const std::vector<ParameterNode *> &fields) {
+    return arena.make<RecordDecl>(name, arena.makeList(fields));
   }
 
-  std::unique_ptr<TypeNode> makeType(const std::string &name) {
-    return std::make_unique<TypeNode>(name);
+  StructDeclarationNode *
+  makeStructDecl(zap::Identifier name,
+                 const std::vector<ParameterNode *> &fields) {
+    return arena.make<StructDeclarationNode>(name, arena.makeList(fields));
   }
 
-  std::unique_ptr<EnumDecl> makeEnumDecl(const std::string &name,
-                                         std::vector<std::string> entries) {
-    return std::make_unique<EnumDecl>(name, std::move(entries));
+  StructLiteralNode *
+  makeStructLiteral(zap::Identifier typeName,
+                    const std::vector<StructFieldInit> &fields) {
+    return arena.make<StructLiteralNode>(typeName, arena.makeList(fields));
   }
 
-  std::unique_ptr<RecordDecl>
-  makeRecordDecl(const std::string &name,
-                 std::vector<std::unique_ptr<ParameterNode>> fields) {
-    return std::make_unique<RecordDecl>(name, std::move(fields));
+  /// @brief Copies items into the arena, for the children of nodes.
+  template <typename T>
+  zap::ArenaList<T> makeList(const std::vector<T> &items) {
+    return arena.makeList(items);
   }
 
   template <typename T> T *setSpan(T *node, const SourceSpan &span) {
@@ -164,4 +182,7 @@ public:
     }
     return node;
   }
+
+private:
+  zap::Arena &arena;
 };
@@ -0,0 +1,137 @@
+#include "parallel_parse.hpp"
+#include "../utils/parallel.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace zap
+{
+
+  /// @brief Parts smaller than this aren't worth a thread of their own.
+  static constexpr size_t MIN_PART_SIZE = 0x8000;
+
+  static RootNode *parseSequential(std::string_view source,
+                                   DiagnosticEngine &diag, Arena &arena)
+  {
+    Lexer lexer(diag);
+    TokenStream tokens(lexer, source);
+    Parser parser(tokens, diag, arena);
+    return parser.parse();
+  }
+
+  /// @brief Splits source into about count parts by matching braces. Parts
+  /// start at a top-level 'fun' right after the end of another declaration,
+  /// so 'extern fun' is never split.
+  /// @return The offsets where the parts start, empty if source doesn't lex.
+  static std::vector<size_t> splitParts(std::string_view source,
+                                        const DiagnosticEngine &diag,
+                                        size_t count)
+  {
+    // Lexer errors are reported by the sequential parse.
+    std::string ignored;
+    StringStream sink(ignored);
+    DiagnosticEngine scanDiag(diag, sink);
+    Lexer lexer(scanDiag);
+    lexer.reset(source);
+
+    std::vector<size_t> starts{0};
+    size_t partSize = source.size() / count;
+    size_t depth = 0;
+    TokenType last = TokenType::SEMICOLON;
+    Token token;
+    while (lexer.next(token))
+    {
+      if (token.type == TokenType::LBRACE)
+      {
+        ++depth;
+      }
+      else if (token.type == TokenType::RBRACE)
+      {
+        depth -= depth > 0;
+      }
+      else if (depth == 0 && token.type == TokenType::FUN &&
+               (last == TokenType::RBRACE || last == TokenType::SEMICOLON) &&
+               token.span.offset - starts.back() >= partSize)
+      {
+        starts.push_back(token.span.offset);
+      }
+
+      if (depth == 0)
+      {
+        last = token.type;
+      }
+    }
+
+    if (lexer.hadErrors())
+    {
+      return {};
+    }
+    return starts;
+  }
+
+  RootNode *parseParallel(std::string_view source, DiagnosticEngine &diag,
+                          Arena &arena, unsigned threads)
+  {
+    size_t count = std::min<size_t>(size_t(threads) * 4,
+                                    source.size() / MIN_PART_SIZE);
+    if (threads <= 1 || count <= 1)
+    {
+      return parseSequential(source, diag, arena);
+    }
+
+    std::vector<size_t> starts = splitParts(source, diag, count);
+    if (starts.size() <= 1)
+    {
+      return parseSequential(source, diag, arena);
+    }
+
+    // Allocating from one arena isn't thread-safe, every part gets its own.
+    // They are owned by arena, so the tree lives exactly as long as before.
+    size_t parts = starts.size();
+    std::vector<Arena *> arenas(parts);
+    for (Arena *&partArena : arenas)
+    {
+      partArena = arena.make<Arena>();
+    }
+
+    std::vector<RootNode *> roots(parts);
+    std::vector<char> failed(parts, 0);
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
+    {
+      for (size_t i = next++; i < parts; i = next++)
+      {
+        size_t end = i + 1 < parts ? starts[i + 1] : source.size();
+        std::string ignored;
+        StringStream sink(ignored);
+        DiagnosticEngine partDiag(diag, sink);
+        Lexer lexer(partDiag);
+        TokenStream tokens(lexer, source.substr(0, end), starts[i]);
+        Parser parser(tokens, partDiag, *arenas[i]);
+        roots[i] = parser.parse();
+        failed[i] = partDiag.hadErrors();
+      }
+    };
+    runOnThreads(std::min<size_t>(threads, parts), worker);
+
+    // A part that doesn't parse on its own may report errors the whole file
+    // doesn't, or in another order, so broken files are parsed again as one.
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+    {
+      return parseSequential(source, diag, arena);
+    }
+
+    std::vector<Node *> children;
+    for (RootNode *root : roots)
+    {
+      children.insert(children.end(), root->children.begin(),
+                      root->children.end());
+    }
+
+    AstBuilder builder(arena);
+    RootNode *root = builder.makeRoot();
+    root->children = builder.makeList(children);
+    return root;
+  }
+
+} // namespace zap
@@ -0,0 +1,16 @@
+#pragma once
+#include "../ast/root_node.hpp"
+#include "../utils/arena.hpp"
+#include "../utils/diagnostics.hpp"
+#include <string_view>
+
+namespace zap
+{
+
+  /// @brief Parses source like Parser::parse() does, but splits big files at
+  /// top-level functions and parses the parts on up to threads threads.
+  /// The nodes are allocated in arena, which has to outlive the tree.
+  RootNode *parseParallel(std::string_view source, DiagnosticEngine &diag,
+                          Arena &arena, unsigned threads);
+
+} // namespace zap
@@ -5,41 +5,84 @@
 namespace zap
 {
 
-  Parser::Parser(const std::vector<Token> &tokens, DiagnosticEngine &diag)
-      : _diag(diag), _tokens(tokens), _pos(0) {}
+  /// @brief Processes the escape sequences of a string or char literal.
+  /// @param raw Text between the quotes.
+  /// @param isString Whether '\w' (space) is allowed, it is string only.
+  static std::string unescape(std::string_view raw, bool isString)
+  {
+    std::string result;
+    result.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+      if (raw[i] != '\\' || i + 1 >= raw.size())
+      {
+        result += raw[i];
+        continue;
+      }
+
+      switch (raw[++i])
+      {
+      case 'n':
+        result += '\n';
+        break;
+      case 't':
+        result += '\t';
+        break;
+      case 'r':
+        result += '\r';
+        break;
+      case '0':
+        result += '\0';
+        break;
+      case 'w':
+        result += isString ? ' ' : 'w';
+        break;
+      default:
+        result += raw[i];
+        break;
+      }
+    }
+    return result;
+  }
+
+  Parser::Parser(TokenStream &tokens, DiagnosticEngine &diag, Arena &arena,
+                 BodyMode bodyMode)
+      : _diag(diag), _tokens(tokens), _arena(arena), _builder(arena),
+        _bodyMode(bodyMode) {}
 
   Parser::~Parser() {}
 
-  std::unique_ptr<RootNode> Parser::parse()
+  RootNode *Parser::parse()
   {
     auto root = _builder.makeRoot();
+    std::vector<Node *> children;
     while (!isAtEnd())
     {
       try
       {
         if (peek().type == TokenType::FUN)
         {
-          root->addChild(parseFunDecl());
+          children.push_back(parseFunDecl());
         }
         else if (peek().type == TokenType::EXTERN)
         {
-          root->addChild(parseExtDecl());
+          children.push_back(parseExtDecl());
         }
         else if (peek().type == TokenType::ENUM)
         {
-          root->addChild(parseEnumDecl());
+          children.push_back(parseEnumDecl());
         }
         else if (peek().type == TokenType::STRUCT)
         {
-          root->addChild(parseStructDecl());
+          children.push_back(parseStructDecl());
         }
         else if (peek().type == TokenType::RECORD)
         {
-          root->addChild(parseRecordDecl());
+          children.push_back(parseRecordDecl());
         }
         else if (peek().type == TokenType::CONST)
         {
-          root->addChild(parseConstDecl());
+          children.push_back(parseConstDecl());
         }
         else if (peek().type == TokenType::GLOBAL)
         {
@@ -48,21 +91,20 @@ namespace zap
           {
             auto varDecl = parseVarDecl();
             varDecl->isGlobal_ = true;
-            _builder.setSpan(varDecl.get(), SourceSpan::merge(globalToken.span, varDecl->span));
-            root->addChild(std::move(varDecl));
+            _builder.setSpan(varDecl, SourceSpan::merge(globalToken.span, varDecl->span));
+            children.push_back(varDecl);
           }
           else
           {
-            _diag.report(peek().span, DiagnosticLevel::Error, "Expected 'var' after 'global'");
-            _pos++;
+            error(peek().span, "Expected 'var' after 'global'");
+            _tokens.advance();
             synchronize();
           }
         }
         else
         {
-          _diag.report(peek().span, DiagnosticLevel::Error,
-                       "Unexpected token " + peek().value);
-          _pos++;
+          error(peek().span, "Unexpected token " + std::string(peek().value));
+          _tokens.advance();
           synchronize();
         }
       }
@@ -71,26 +113,29 @@ namespace zap
         synchronize();
       }
     }
+    root->children = _builder.makeList(children);
     return root;
   }
 
-  std::unique_ptr<FunDecl> Parser::parseFunDecl()
+  FunDecl *Parser::parseFunDecl()
   {
     Token funKeyword = eat(TokenType::FUN);
 
     Token funNameToken = eat(TokenType::ID);
-    auto funDecl = _builder.makeFunDecl(funNameToken.value);
+    auto funDecl = _builder.makeFunDecl(funNameToken.ident);
 
     eat(TokenType::LPAREN);
 
+    std::vector<ParameterNode *> params;
     if (peek().type != TokenType::RPAREN)
     {
       do
       {
-        funDecl->params_.push_back(parseParameter());
+        params.push_back(parseParameter());
       } while (peek().type == TokenType::COMMA &&
                eat(TokenType::COMMA).type == TokenType::COMMA);
     }
+    funDecl->params_ = _builder.makeList(params);
 
     eat(TokenType::RPAREN);
 
@@ -98,9 +143,16 @@ namespace zap
     {
       funDecl->returnType_ = parseType();
     }
-    else
+
+    if (_bodyMode == BodyMode::Lazy)
     {
-      funDecl->returnType_.reset();
+      Token lbraceToken = peek();
+      Token rbraceToken = skipBody();
+      funDecl->skippedBody_ =
+          SourceSpan::merge(lbraceToken.span, rbraceToken.span);
+      _builder.setSpan(funDecl,
+               SourceSpan::merge(funNameToken.span, rbraceToken.span));
+      return funDecl;
     }
 
     eat(TokenType::LBRACE);
@@ -109,31 +161,92 @@ namespace zap
 
     Token rbraceToken = eat(TokenType::RBRACE);
 
-    _builder.setSpan(funDecl.get(),
+    _builder.setSpan(funDecl,
              SourceSpan::merge(funNameToken.span, rbraceToken.span));
 
     return funDecl;
   }
 
-  std::unique_ptr<ExtDecl> Parser::parseExtDecl()
+  /// @brief Skips a body by matching braces, without looking at what's in
+  /// between.
+  /// @return The closing brace.
+  Token Parser::skipBody()
+  {
+    eat(TokenType::LBRACE);
+    for (size_t depth = 1; depth > 0;)
+    {
+      if (isAtEnd())
+      {
+        eat(TokenType::RBRACE); // Reports the missing brace.
+      }
+      TokenType type = _tokens.advance().type;
+      if (type == TokenType::LBRACE)
+      {
+        ++depth;
+      }
+      else if (type == TokenType::RBRACE)
+      {
+        --depth;
+      }
+    }
+    return _tokens.previous();
+  }
+
+  BodyNode *Parser::parseBody(FunDecl &funDecl)
+  {
+    if (!funDecl.isBodySkipped())
+    {
+      return funDecl.body_;
+    }
+
+    // The body is lexed again on its own, its spans are still relative to
+    // the whole source.
+    SourceSpan range = funDecl.skippedBody_;
+    std::string_view source =
+        _tokens.input().substr(0, range.offset + range.length);
+    Lexer lexer(_diag);
+    TokenStream tokens(lexer, source, range.offset);
+    Parser parser(tokens, _diag, _arena);
+    try
+    {
+      parser.eat(TokenType::LBRACE);
+      funDecl.body_ = parser.parseBody();
+      parser.eat(TokenType::RBRACE);
+    }
+    catch (const ParseError &e)
+    {
+      // The error was reported before it was thrown, an empty body stands in
+      // for the broken one.
+    }
+
+    if (!funDecl.body_)
+    {
+      funDecl.body_ = _builder.makeBody();
+    }
+    funDecl.skippedBody_ = SourceSpan();
+    return funDecl.body_;
+  }
+
+  ExtDecl *Parser::parseExtDecl()
   {
     Token externKeyword = eat(TokenType::EXTERN);
     Token funKeyword = eat(TokenType::FUN);
 
     Token funNameToken = eat(TokenType::ID);
-    auto extDecl = std::make_unique<ExtDecl>();
-    extDecl->name_ = funNameToken.value;
+    auto extDecl = _builder.makeExtDecl(funNameToken.ident);
 
     eat(TokenType::LPAREN);
 
+    std::vector<ParameterNode *> params;
     if (peek().type != TokenType::RPAREN)
     {
       do
       {
-        extDecl->params_.push_back(parseParameter());
+        params.push_back(parseParameter());
       } while (peek().type == TokenType::COMMA &&
                eat(TokenType::COMMA).type == TokenType::COMMA);
     }
+    extDecl->params_ = _builder.makeList(params);
 
     eat(TokenType::RPAREN);
 
@@ -145,37 +258,40 @@ namespace zap
     {
       extDecl->returnType_ = _builder.makeType("void");
       const auto &nextToken = peek();
-      _builder.setSpan(extDecl->returnType_.get(),
-                       SourceSpan(nextToken.span.line, nextToken.span.column,
-                                  nextToken.span.offset, 0));
+      _builder.setSpan(extDecl->returnType_,
+                       SourceSpan(nextToken.span.offset, 0));
     }
 
     Token semiToken = eat(TokenType::SEMICOLON);
 
-    _builder.setSpan(extDecl.get(),
+    _builder.setSpan(extDecl,
              SourceSpan::merge(funNameToken.span, semiToken.span));
 
     return extDecl;
   }
 
-  std::unique_ptr<BodyNode> Parser::parseBody()
+  BodyNode *Parser::parseBody()
   {
     auto body = _builder.makeBody();
-    while (!isAtEnd() && peek().type != TokenType::RBRACE)
+    std::vector<Node *> statements;
+    // A declaration can't be a statement, the body is missing its closing
+    // brace. It's left for parse(), which reports the brace and resumes there.
+    while (!isAtEnd() && peek().type != TokenType::RBRACE &&
+           !isAtDeclaration())
     {
       try
       {
         if (peek().type == TokenType::VAR)
         {
-          body->addStatement(parseVarDecl());
+          statements.push_back(parseVarDecl());
         }
         else if (peek().type == TokenType::CONST)
         {
-          body->addStatement(parseConstDecl());
+          statements.push_back(parseConstDecl());
         }
         else if (peek().type == TokenType::RETURN)
         {
-          body->addStatement(parseReturnStmt());
+          statements.push_back(parseReturnStmt());
         }
         else if (peek().type == TokenType::IF)
         {
@@ -183,15 +299,15 @@ namespace zap
           if (peek().type == TokenType::SEMICOLON)
           {
             eat(TokenType::SEMICOLON);
-            body->addStatement(std::move(ifNode));
+            statements.push_back(ifNode);
           }
           else if (peek().type == TokenType::RBRACE)
           {
-            body->setResult(std::move(ifNode));
+            body->result = ifNode;
           }
           else
           {
-            body->addStatement(std::move(ifNode));
+            statements.push_back(ifNode);
           }
         }
         else if (peek().type == TokenType::WHILE)
@@ -201,15 +317,15 @@ namespace zap
           {
             eat(TokenType::SEMICOLON);
           }
-          body->addStatement(std::move(whileNode));
+          statements.push_back(whileNode);
         }
         else if (peek().type == TokenType::BREAK)
         {
-          body->addStatement(parseBreak());
+          statements.push_back(parseBreak());
         }
         else if (peek().type == TokenType::CONTINUE)
         {
-          body->addStatement(parseContinue());
+          statements.push_back(parseContinue());
         }
         else
         {
@@ -219,24 +335,24 @@ namespace zap
             eat(TokenType::ASSIGN);
             auto value = parseExpression();
             Token semi = eat(TokenType::SEMICOLON);
-            auto assign = _builder.makeAssign(std::move(expr), std::move(value));
-            _builder.setSpan(assign.get(), SourceSpan::merge(assign->target_->span, semi.span));
-            body->addStatement(std::move(assign));
+            auto assign = _builder.makeAssign(expr, value);
+            _builder.setSpan(assign, SourceSpan::merge(assign->target_->span, semi.span));
+            statements.push_back(assign);
           }
           else if (peek().type == TokenType::SEMICOLON)
           {
             eat(TokenType::SEMICOLON);
-            body->addStatement(std::move(expr));
+            statements.push_back(expr);
           }
           else
           {
             if (peek().type == TokenType::RBRACE)
             {
-              body->setResult(std::move(expr));
+              body->result = expr;
             }
             else
             {
-              body->addStatement(std::move(expr));
+              statements.push_back(expr);
             }
           }
         }
@@ -246,22 +362,22 @@ namespace zap
         synchronize();
       }
     }
+    body->statements = _builder.makeList(statements);
     return body;
   }
 
-  std::unique_ptr<ParameterNode> Parser::parseParameter()
+  ParameterNode *Parser::parseParameter()
   {
     Token paramNameToken = eat(TokenType::ID);
     eat(TokenType::COLON);
     auto typeNode = parseType();
-    auto paramNode =
-        _builder.makeParam(paramNameToken.value, std::move(typeNode));
-    _builder.setSpan(paramNode.get(), SourceSpan::merge(paramNameToken.span,
+    auto paramNode = _builder.makeParam(paramNameToken.ident, typeNode);
+    _builder.setSpan(paramNode, SourceSpan::merge(paramNameToken.span,
                                                         paramNode->type->span));
     return paramNode;
   }
 
-  std::unique_ptr<VarDecl> Parser::parseVarDecl()
+  VarDecl *Parser::parseVarDecl()
   {
     Token varKeyword = eat(TokenType::VAR);
     Token varNameToken = eat(TokenType::ID);
@@ -276,9 +392,8 @@ namespace zap
       auto expr = parseExpression();
       Token semicolonToken = eat(TokenType::SEMICOLON);
 
-      auto varDecl = _builder.makeVarDecl(varNameToken.value, std::move(typeNode),
-                                          std::move(expr));
-      _builder.setSpan(varDecl.get(),
+      auto varDecl = _builder.makeVarDecl(varNameToken.ident, typeNode, expr);
+      _builder.setSpan(varDecl,
                        SourceSpan::merge(varKeyword.span, semicolonToken.span));
       return varDecl;
     }
@@ -286,14 +401,14 @@ namespace zap
     {
       Token semicolonToken = eat(TokenType::SEMICOLON);
       auto varDecl =
-          _builder.makeVarDecl(varNameToken.value, std::move(typeNode), nullptr);
-      _builder.setSpan(varDecl.get(),
+          _builder.makeVarDecl(varNameToken.ident, typeNode, nullptr);
+      _builder.setSpan(varDecl,
                        SourceSpan::merge(varKeyword.span, semicolonToken.span));
       return varDecl;
     }
   }
 
-  std::unique_ptr<ConstDecl> Parser::parseConstDecl()
+  ConstDecl *Parser::parseConstDecl()
   {
     Token constKeyword = eat(TokenType::CONST);
     Token constNameToken = eat(TokenType::ID);
@@ -306,14 +421,14 @@ namespace zap
     auto expr = parseExpression();
     Token semicolonToken = eat(TokenType::SEMICOLON);
 
-    auto constDecl = _builder.makeConstDecl(constNameToken.value, std::move(typeNode),
-                                            std::move(expr));
-    _builder.setSpan(constDecl.get(),
+    auto constDecl =
+        _builder.makeConstDecl(constNameToken.ident, typeNode, expr);
+    _builder.setSpan(constDecl,
                      SourceSpan::merge(constKeyword.span, semicolonToken.span));
     return constDecl;
   }
 
-  std::unique_ptr<AssignNode> Parser::parseAssign()
+  AssignNode *Parser::parseAssign()
   {
     auto target = parseExpression();
     eat(TokenType::ASSIGN);
@@ -321,13 +436,13 @@ namespace zap
     Token semicolonToken = eat(TokenType::SEMICOLON);
 
     SourceSpan startSpan = target->span;
-    auto node = _builder.makeAssign(std::move(target), std::move(expr));
-    _builder.setSpan(node.get(),
+    auto node = _builder.makeAssign(target, expr);
+    _builder.setSpan(node,
                      SourceSpan::merge(startSpan, semicolonToken.span));
     return node;
   }
 
-  std::unique_ptr<TypeNode> Parser::parseType()
+  TypeNode *Parser::parseType()
   {
     if (peek().type == TokenType::SQUARE_LBRACE &&
         (peek(1).type == TokenType::INTEGER || peek(1).type == TokenType::ID || peek(1).type == TokenType::SQUARE_LBRACE))
@@ -339,23 +454,23 @@ namespace zap
       
       auto arrayType = _builder.makeType("");
       arrayType->isArray = true;
-      arrayType->arraySize = std::move(size);
-      arrayType->baseType = std::move(baseType);
+      arrayType->arraySize = size;
+      arrayType->baseType = baseType;
       
-      _builder.setSpan(arrayType.get(),
+      _builder.setSpan(arrayType,
                        SourceSpan::merge(lbracket.span, arrayType->baseType->span));
       return arrayType;
     }
     Token t = eat(TokenType::ID);
-    auto typeNode = _builder.makeType(t.value);
-    _builder.setSpan(typeNode.get(), t.span);
+    auto typeNode = _builder.makeType(t.ident);
+    _builder.setSpan(typeNode, t.span);
     return typeNode;
   }
 
-  std::unique_ptr<ArrayLiteralNode> Parser::parseArrayLiteral()
+  ArrayLiteralNode *Parser::parseArrayLiteral()
   {
     Token lbrace = eat(TokenType::LBRACE);
-    std::vector<std::unique_ptr<ExpressionNode>> elements;
+    std::vector<ExpressionNode *> elements;
     if (peek().type != TokenType::RBRACE)
     {
       do
@@ -365,12 +480,12 @@ namespace zap
                eat(TokenType::COMMA).type == TokenType::COMMA);
     }
     Token rbrace = eat(TokenType::RBRACE);
-    auto node = _builder.makeArrayLiteral(std::move(elements));
-    _builder.setSpan(node.get(), SourceSpan::merge(lbrace.span, rbrace.span));
+    auto node = _builder.makeArrayLiteral(elements);
+    _builder.setSpan(node, SourceSpan::merge(lbrace.span, rbrace.span));
     return node;
   }
 
-  std::unique_ptr<IfNode> Parser::parseIf()
+  IfNode *Parser::parseIf()
   {
     Token ifKeyword = eat(TokenType::IF);
 
@@ -397,8 +512,8 @@ namespace zap
     auto thenBody = parseBody();
     eat(TokenType::RBRACE);
 
-    std::unique_ptr<BodyNode> elseBody = nullptr;
-    SourceSpan endSpan = _tokens[_pos - 1].span;
+    BodyNode *elseBody = nullptr;
+    SourceSpan endSpan = _tokens.previous().span;
 
     if (peek().type == TokenType::ELSE)
     {
@@ -408,8 +523,8 @@ namespace zap
         auto nestedIf = parseIf();
         elseBody = _builder.makeBody();
         SourceSpan nestedSpan = nestedIf->span;
-        elseBody->addStatement(std::move(nestedIf));
-        _builder.setSpan(elseBody.get(), nestedSpan);
+        elseBody->statements = _builder.makeList(std::vector<Node *>{nestedIf});
+        _builder.setSpan(elseBody, nestedSpan);
         endSpan = nestedSpan;
       }
       else
@@ -421,14 +536,14 @@ namespace zap
       }
     }
 
-    auto ifNode = _builder.makeIf(std::move(condition), std::move(thenBody),
-                                  std::move(elseBody));
+    auto ifNode = _builder.makeIf(condition, thenBody,
+                                  elseBody);
 
-    _builder.setSpan(ifNode.get(), SourceSpan::merge(ifKeyword.span, endSpan));
+    _builder.setSpan(ifNode, SourceSpan::merge(ifKeyword.span, endSpan));
     return ifNode;
   }
 
-  std::unique_ptr<WhileNode> Parser::parseWhile()
+  WhileNode *Parser::parseWhile()
   {
     Token whileKeyword = eat(TokenType::WHILE);
 
@@ -455,53 +570,52 @@ namespace zap
     auto body = parseBody();
     Token rbraceToken = eat(TokenType::RBRACE);
 
-    auto whileNode = _builder.makeWhile(std::move(condition), std::move(body));
-    _builder.setSpan(whileNode.get(),
+    auto whileNode = _builder.makeWhile(condition, body);
+    _builder.setSpan(whileNode,
                      SourceSpan::merge(whileKeyword.span, rbraceToken.span));
     return whileNode;
   }
 
-  std::unique_ptr<ReturnNode> Parser::parseReturnStmt()
+  ReturnNode *Parser::parseReturnStmt()
   {
     Token returnKeyword = eat(TokenType::RETURN);
-    std::unique_ptr<ExpressionNode> expr = nullptr;
+    ExpressionNode *expr = nullptr;
     if (peek().type != TokenType::SEMICOLON) {
       expr = parseExpression();
     }
 
     Token semicolonToken = eat(TokenType::SEMICOLON);
 
-    auto returnNode = _builder.makeReturn(std::move(expr));
-    _builder.setSpan(returnNode.get(),
+    auto returnNode = _builder.makeReturn(expr);
+    _builder.setSpan(returnNode,
                      SourceSpan::merge(returnKeyword.span, semicolonToken.span));
     return returnNode;
   }
 
-  std::unique_ptr<BreakNode> Parser::parseBreak()
+  BreakNode *Parser::parseBreak()
   {
     Token breakKeyword = eat(TokenType::BREAK);
     Token semicolonToken = eat(TokenType::SEMICOLON);
     auto node = _builder.makeBreak();
-    _builder.setSpan(node.get(), SourceSpan::merge(breakKeyword.span, semicolonToken.span));
+    _builder.setSpan(node, SourceSpan::merge(breakKeyword.span, semicolonToken.span));
     return node;
   }
 
-  std::unique_ptr<ContinueNode> Parser::parseContinue()
+  ContinueNode *Parser::parseContinue()
   {
     Token continueKeyword = eat(TokenType::CONTINUE);
     Token semicolonToken = eat(TokenType::SEMICOLON);
     auto node = _builder.makeContinue();
-    _builder.setSpan(node.get(), SourceSpan::merge(continueKeyword.span, semicolonToken.span));
+    _builder.setSpan(node, SourceSpan::merge(continueKeyword.span, semicolonToken.span));
     return node;
   }
 
-  std::unique_ptr<ExpressionNode> Parser::parseExpression()
+  ExpressionNode *Parser::parseExpression()
   {
     return parseBinaryExpression(0);
   }
 
-  std::unique_ptr<ExpressionNode>
-  Parser::parseBinaryExpression(int minPrecedence)
+  ExpressionNode *Parser::parseBinaryExpression(int minPrecedence)
   {
     auto left = parseUnaryExpression();
 
@@ -526,29 +640,28 @@ namespace zap
 
       SourceSpan leftSpan = left->span;
       SourceSpan rightSpan = right->span;
-      left = _builder.makeBinExpr(std::move(left), opToken.value,
-                                  std::move(right));
-      _builder.setSpan(static_cast<BinExpr *>(left.get()),
+      left = _builder.makeBinExpr(left, binaryOpFromToken(opToken.type), right);
+      _builder.setSpan(static_cast<BinExpr *>(left),
                        SourceSpan::merge(leftSpan, rightSpan));
     }
     return left;
   }
 
-  std::unique_ptr<ExpressionNode> Parser::parseUnaryExpression()
+  ExpressionNode *Parser::parseUnaryExpression()
   {
     if (peek().type == TokenType::NOT || peek().type == TokenType::MINUS)
     {
       Token opToken = eat(peek().type);
       auto expr = parseUnaryExpression();
       SourceSpan endSpan = expr->span;
-      auto node = _builder.makeUnaryExpr(opToken.value, std::move(expr));
-      _builder.setSpan(node.get(), SourceSpan::merge(opToken.span, endSpan));
+      auto node = _builder.makeUnaryExpr(unaryOpFromToken(opToken.type), expr);
+      _builder.setSpan(node, SourceSpan::merge(opToken.span, endSpan));
       return node;
     }
     return parsePostfixExpression();
   }
 
-  std::unique_ptr<ExpressionNode> Parser::parsePostfixExpression()
+  ExpressionNode *Parser::parsePostfixExpression()
   {
     auto left = parsePrimaryExpression();
 
@@ -563,8 +676,8 @@ namespace zap
         eat(TokenType::DOT);
         Token memberToken = eat(TokenType::ID);
         SourceSpan leftSpan = left->span;
-        left = std::move(_builder.makeMemberAccess(std::move(left), memberToken.value));
-        _builder.setSpan(left.get(), SourceSpan::merge(leftSpan, memberToken.span));
+        left = _builder.makeMemberAccess(left, memberToken.ident);
+        _builder.setSpan(left, SourceSpan::merge(leftSpan, memberToken.span));
       }
       else if (opToken.type == TokenType::SQUARE_LBRACE)
       {
@@ -572,8 +685,8 @@ namespace zap
         auto index = parseExpression();
         Token rbracket = eat(TokenType::SQUARE_RBRACE);
         SourceSpan leftSpan = left->span;
-        left = _builder.makeIndexAccess(std::move(left), std::move(index));
-        _builder.setSpan(left.get(), SourceSpan::merge(leftSpan, rbracket.span));
+        left = _builder.makeIndexAccess(left, index);
+        _builder.setSpan(left, SourceSpan::merge(leftSpan, rbracket.span));
       }
       else
       {
@@ -583,43 +696,42 @@ namespace zap
     return left;
   }
 
-  std::unique_ptr<ExpressionNode> Parser::parsePrimaryExpression()
+  ExpressionNode *Parser::parsePrimaryExpression()
   {
     Token current = peek();
     if (current.type == TokenType::INTEGER)
     {
       eat(TokenType::INTEGER);
-      int64_t val = static_cast<int64_t>(std::stoull(current.value));
-      auto constInt = _builder.makeConstInt(val);
-      _builder.setSpan(constInt.get(), current.span);
+      auto constInt = _builder.makeConstInt(current.integer);
+      _builder.setSpan(constInt, current.span);
       return constInt;
     }
     else if (current.type == TokenType::FLOAT)
     {
       eat(TokenType::FLOAT);
-      auto constFloat = _builder.makeConstFloat(std::stod(current.value));
-      _builder.setSpan(constFloat.get(), current.span);
+      auto constFloat = _builder.makeConstFloat(current.real);
+      _builder.setSpan(constFloat, current.span);
       return constFloat;
     }
     else if (current.type == TokenType::STRING)
     {
       eat(TokenType::STRING);
-      auto constStr = _builder.makeConstString(current.value);
-      _builder.setSpan(constStr.get(), current.span);
+      auto constStr = _builder.makeConstString(unescape(current.value, true));
+      _builder.setSpan(constStr, current.span);
       return constStr;
     }
     else if (current.type == TokenType::CHAR)
     {
       eat(TokenType::CHAR);
-      auto constChar = _builder.makeConstChar(current.value);
-      _builder.setSpan(constChar.get(), current.span);
+      auto constChar = _builder.makeConstChar(unescape(current.value, false));
+      _builder.setSpan(constChar, current.span);
       return constChar;
     }
     else if (current.type == TokenType::BOOL)
     {
       eat(TokenType::BOOL);
       auto constBool = _builder.makeConstBool(current.value == "true");
-      _builder.setSpan(constBool.get(), current.span);
+      _builder.setSpan(constBool, current.span);
       return constBool;
     }
     else if (current.type == TokenType::ID)
@@ -627,40 +739,41 @@ namespace zap
       Token idToken = eat(TokenType::ID);
       if (peek().type == TokenType::LPAREN)
       {
-        auto funCall = _builder.makeFunCall(idToken.value);
+        auto funCall = _builder.makeFunCall(idToken.ident);
         eat(TokenType::LPAREN);
 
+        std::vector<Argument> args;
         if (peek().type != TokenType::RPAREN)
         {
           do
           {
-            std::string argName = "";
+            zap::Identifier argName;
             if (peek().type == TokenType::ID &&
                 peek(1).type == TokenType::ASSIGN)
             {
-              argName = eat(TokenType::ID).value;
+              argName = eat(TokenType::ID).ident;
               eat(TokenType::ASSIGN);
             }
             auto argValue = parseExpression();
-            funCall->params_.push_back(
-                std::make_unique<Argument>(argName, std::move(argValue)));
+            args.emplace_back(argName, argValue);
           } while (peek().type == TokenType::COMMA &&
                    eat(TokenType::COMMA).type == TokenType::COMMA);
         }
+        funCall->params_ = _builder.makeList(args);
 
         Token rparenToken = eat(TokenType::RPAREN);
-        _builder.setSpan(funCall.get(),
+        _builder.setSpan(funCall,
                          SourceSpan::merge(idToken.span, rparenToken.span));
         return funCall;
       }
       else if (_allowStructLiteral && peek().type == TokenType::LBRACE)
       {
-        return parseStructLiteral(idToken.value);
+        return parseStructLiteral(idToken.ident);
       }
       else
       {
-        auto constId = _builder.makeConstId(idToken.value);
-        _builder.setSpan(constId.get(), idToken.span);
+        auto constId = _builder.makeConstId(idToken.ident);
+        _builder.setSpan(constId, idToken.span);
         return constId;
       }
     }
@@ -672,16 +785,15 @@ namespace zap
       auto expr = parseExpression();
       _allowStructLiteral = oldAllow;
       Token rparenToken = eat(TokenType::RPAREN);
-      _builder.setSpan(static_cast<ExpressionNode *>(expr.get()),
+      _builder.setSpan(static_cast<ExpressionNode *>(expr),
                        SourceSpan::merge(current.span, rparenToken.span));
       return expr;
     }
     else if (current.type == TokenType::LBRACE)
     {
       if (!_allowStructLiteral) {
-          _diag.report(current.span, DiagnosticLevel::Error,
-                       "Struct literal not allowed in this context");
-          exit(EXIT_FAILURE);
+          error(current.span, "Struct literal not allowed in this context");
+          throw ParseError();
       }
       return parseArrayLiteral();
     }
@@ -689,9 +801,9 @@ namespace zap
     {
       return parseIf();
     }
-    _diag.report(current.span, DiagnosticLevel::Error,
-                 "Expected primary expression, got " + current.value);
-    exit(EXIT_FAILURE);
+    error(current.span,
+          "Expected primary expression, got " + std::string(current.value));
+    throw ParseError();
   }
   int Parser::getPrecedence(TokenType type)
   {
@@ -726,34 +838,27 @@ namespace zap
 
   const Token &Parser::peek(size_t offset) const
   {
-    if (_pos + offset >= _tokens.size())
-    {
-      static const Token dummy(TokenType::SEMICOLON, "", SourceSpan(0, 0, 0, 0));
-      return dummy;
-    }
-    return _tokens[_pos + offset];
+    return _tokens.peek(offset);
   }
 
   Token Parser::eat(TokenType expectedType)
   {
     if (isAtEnd())
     {
-      _diag.report(peek().span, DiagnosticLevel::Error,
-                   "Expected " + tokenTypeToString(expectedType) +
-                       " but reached end of file.");
+      error(peek().span, "Expected " + tokenTypeToString(expectedType) +
+                             " but reached end of file.");
       throw ParseError();
     }
-    Token current = _tokens[_pos];
+    const Token &current = peek();
     if (current.type == expectedType)
     {
-      _pos++;
-      return current;
+      return _tokens.advance();
     }
     else
     {
-      _diag.report(current.span, DiagnosticLevel::Error,
-                   "Expected " + tokenTypeToString(expectedType) + ", but got '" +
-                       current.value + "'");
+      error(current.span, "Expected " + tokenTypeToString(expectedType) +
+                              ", but got '" + std::string(current.value) +
+                              "'");
       throw ParseError();
     }
   }
@@ -765,7 +870,7 @@ namespace zap
       switch (peek().type)
       {
       case TokenType::SEMICOLON:
-        _pos++;
+        _tokens.advance();
         return;
       case TokenType::FUN:
       case TokenType::ENUM:
@@ -778,20 +883,46 @@ namespace zap
       case TokenType::RBRACE:
         return;
       default:
-        _pos++;
+        _tokens.advance();
         break;
       }
     }
   }
 
-  bool Parser::isAtEnd() const { return _pos >= _tokens.size(); }
+  bool Parser::isAtEnd() const { return _tokens.isAtEnd(); }
+
+  bool Parser::isAtDeclaration() const
+  {
+    switch (peek().type)
+    {
+    case TokenType::FUN:
+    case TokenType::EXTERN:
+    case TokenType::ENUM:
+    case TokenType::STRUCT:
+    case TokenType::RECORD:
+    case TokenType::GLOBAL:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  void Parser::error(SourceSpan span, const std::string &message)
+  {
+    // Once the lexer failed, the token stream is cut short and every error
+    // would be a follow-up of the lexer's.
+    if (!_tokens.hadErrors())
+    {
+      _diag.report(span, DiagnosticLevel::Error, message);
+    }
+  }
 
-  std::unique_ptr<EnumDecl> Parser::parseEnumDecl()
+  EnumDecl *Parser::parseEnumDecl()
   {
     Token enumKeyword = eat(TokenType::ENUM);
     Token enumNameToken = eat(TokenType::ID);
 
-    std::vector<std::string> entries;
+    std::vector<zap::Identifier> entries;
     eat(TokenType::LBRACE);
 
     if (peek().type != TokenType::RBRACE)
@@ -799,7 +930,7 @@ namespace zap
       do
       {
         Token entryToken = eat(TokenType::ID);
-        entries.push_back(entryToken.value);
+        entries.push_back(entryToken.ident);
       } while (peek().type == TokenType::COMMA &&
                eat(TokenType::COMMA).type == TokenType::COMMA);
     }
@@ -807,18 +938,18 @@ namespace zap
     Token rbraceToken = eat(TokenType::RBRACE);
 
     auto enumDecl =
-        _builder.makeEnumDecl(enumNameToken.value, std::move(entries));
-    _builder.setSpan(enumDecl.get(),
+        _builder.makeEnumDecl(enumNameToken.ident, entries);
+    _builder.setSpan(enumDecl,
                      SourceSpan::merge(enumKeyword.span, rbraceToken.span));
     return enumDecl;
   }
 
-  std::unique_ptr<RecordDecl> Parser::parseRecordDecl()
+  RecordDecl *Parser::parseRecordDecl()
   {
     Token recordKeyword = eat(TokenType::RECORD);
     Token recordNameToken = eat(TokenType::ID);
 
-    std::vector<std::unique_ptr<ParameterNode>> fields;
+    std::vector<ParameterNode *> fields;
     eat(TokenType::LBRACE);
 
     while (peek().type != TokenType::RBRACE)
@@ -834,18 +965,18 @@ namespace zap
     Token rbraceToken = eat(TokenType::RBRACE);
 
     auto recordDecl =
-        _builder.makeRecordDecl(recordNameToken.value, std::move(fields));
-    _builder.setSpan(recordDecl.get(),
+        _builder.makeRecordDecl(recordNameToken.ident, fields);
+    _builder.setSpan(recordDecl,
                      SourceSpan::merge(recordKeyword.span, rbraceToken.span));
     return recordDecl;
   }
 
-  std::unique_ptr<StructDeclarationNode> Parser::parseStructDecl()
+  StructDeclarationNode *Parser::parseStructDecl()
   {
     Token structKeyword = eat(TokenType::STRUCT);
     Token structNameToken = eat(TokenType::ID);
 
-    std::vector<std::unique_ptr<ParameterNode>> fields;
+    std::vector<ParameterNode *> fields;
     eat(TokenType::LBRACE);
 
     if (peek().type != TokenType::RBRACE)
@@ -866,10 +997,10 @@ namespace zap
     }
 
     eat(TokenType::RBRACE);
-    return std::make_unique<StructDeclarationNode>(structNameToken.value, std::move(fields));
+    return _builder.makeStructDecl(structNameToken.ident, fields);
   }
 
-  std::unique_ptr<StructLiteralNode> Parser::parseStructLiteral(const std::string& type_name)
+  StructLiteralNode *Parser::parseStructLiteral(zap::Identifier type_name)
   {
     eat(TokenType::LBRACE);
     std::vector<StructFieldInit> fields;
@@ -881,7 +1012,7 @@ namespace zap
         Token fieldName = eat(TokenType::ID);
         eat(TokenType::COLON);
         auto value = parseExpression();
-        fields.emplace_back(fieldName.value, std::move(value));
+        fields.emplace_back(fieldName.ident, value);
         
         if (peek().type == TokenType::COMMA || peek().type == TokenType::SEMICOLON)
         {
@@ -895,7 +1026,7 @@ namespace zap
     }
 
     eat(TokenType::RBRACE);
-    return std::make_unique<StructLiteralNode>(type_name, std::move(fields));
+    return _builder.makeStructLiteral(type_name, fields);
   }
 
 } // namespace zap
@@ -19,10 +19,11 @@
 #include "../ast/var_decl.hpp"
 #include "../ast/while_node.hpp"
 #include "../ast/member_access.hpp"
+#include "../lexer/token_stream.hpp"
 #include "../token/token.hpp"
+#include "../utils/arena.hpp"
 #include "../utils/diagnostics.hpp"
 #include "ast_builder.hpp"
-#include <memory>
 #include <vector>
 
 namespace zap
@@ -37,48 +38,69 @@ namespace zap
       ParseError() : std::runtime_error("Parse error") {}
     };
 
-    Parser(const std::vector<Token> &toks, DiagnosticEngine &diag);
+    /// @brief What parse() does with function bodies.
+    enum class BodyMode
+    {
+      Eager, ///< Bodies are parsed with the rest.
+      Lazy,  ///< Bodies are skipped by matching braces, for consumers that
+             ///< only need declarations, and parsed by parseBody() on demand.
+    };
+
+    /// @brief The parser pulls its tokens from the stream while parsing and
+    /// allocates the nodes in arena, which has to outlive the tree.
+    Parser(TokenStream &tokens, DiagnosticEngine &diag, Arena &arena,
+           BodyMode bodyMode = BodyMode::Eager);
     ~Parser();
-    std::unique_ptr<RootNode> parse(); // Returns the root of the AST
+    RootNode *parse(); // Returns the root of the AST
+
+    /// @brief Parses the body of a function skipped in lazy mode, the first
+    /// call does the work, later ones return the same body. The source and
+    /// arena parse() used have to still be alive.
+    BodyNode *parseBody(FunDecl &funDecl);
 
   private:
     DiagnosticEngine &_diag;
-    std::vector<Token> _tokens;
-    size_t _pos;
+    TokenStream &_tokens;
+    Arena &_arena;
     AstBuilder _builder;
+    BodyMode _bodyMode;
     bool _allowStructLiteral = true;
 
     // Helper methods
     const Token &peek(size_t offset = 0) const;
     Token eat(TokenType expectedType);
     bool isAtEnd() const;
+    /// @brief Whether the next token starts a top-level declaration.
+    bool isAtDeclaration() const;
     void synchronize();
+    void error(SourceSpan span, const std::string &message);
+    Token skipBody();
 
     // Parsing rules
-    std::unique_ptr<FunDecl> parseFunDecl();
-    std::unique_ptr<ExtDecl> parseExtDecl();
-    std::unique_ptr<BodyNode> parseBody();
-    std::unique_ptr<VarDecl> parseVarDecl();
-    std::unique_ptr<ConstDecl> parseConstDecl();
-    std::unique_ptr<AssignNode> parseAssign();
-    std::unique_ptr<TypeNode> parseType();
-    std::unique_ptr<ArrayLiteralNode> parseArrayLiteral();
-    std::unique_ptr<IfNode> parseIf();
-    std::unique_ptr<WhileNode> parseWhile();
-    std::unique_ptr<ReturnNode> parseReturnStmt();
-    std::unique_ptr<ExpressionNode> parseExpression();
-    std::unique_ptr<ExpressionNode> parseBinaryExpression(int minPrecedence);
-    std::unique_ptr<ExpressionNode> parseUnaryExpression();
-    std::unique_ptr<ExpressionNode> parsePostfixExpression();
-    std::unique_ptr<ExpressionNode> parsePrimaryExpression();
+    FunDecl *parseFunDecl();
+    ExtDecl *parseExtDecl();
+    BodyNode *parseBody();
+    VarDecl *parseVarDecl();
+    ConstDecl *parseConstDecl();
+    AssignNode *parseAssign();
+    TypeNode *parseType();
+    ArrayLiteralNode *parseArrayLiteral();
+    IfNode *parseIf();
+    WhileNode *parseWhile();
+    ReturnNode *parseReturnStmt();
+    ExpressionNode *parseExpression();
+    ExpressionNode *parseBinaryExpression(int minPrecedence);
+    ExpressionNode *parseUnaryExpression();
+    ExpressionNode *parsePostfixExpression();
+    ExpressionNode *parsePrimaryExpression();
 
     int getPrecedence(TokenType type);
-    std::unique_ptr<ParameterNode> parseParameter();
-    std::unique_ptr<EnumDecl> parseEnumDecl();
-    std::unique_ptr<RecordDecl> parseRecordDecl();
-    std::unique_ptr<StructDeclarationNode> parseStructDecl();
-    std::unique_ptr<StructLiteralNode> parseStructLiteral(const std::string& type_name);
-    std::unique_ptr<BreakNode> parseBreak();
-    std::unique_ptr<ContinueNode> parseContinue();
+    ParameterNode *parseParameter();
+    EnumDecl *parseEnumDecl();
+    RecordDecl *parseRecordDecl();
+    StructDeclarationNode *parseStructDecl();
+    StructLiteralNode *parseStructLiteral(zap::Identifier type_name);
+    BreakNode *parseBreak();
+    ContinueNode *parseContinue();
   };
 } // namespace zap
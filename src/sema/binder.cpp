@@ -2,83 +2,82 @@
 #include "../ast/enum_decl.hpp"
 #include "../ast/record_decl.hpp"
 #include "../ast/const/const_char.hpp"
+#include "../utils/parallel.hpp"
+#include "constant_folder.hpp"
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 
 namespace sema
 {
 
+  /// @brief Functions smaller than this together aren't worth extra threads.
+  static constexpr size_t MIN_PARALLEL_SIZE = 0x8000;
+
   Binder::Binder(zap::DiagnosticEngine &diag) : _diag(diag), hadError_(false) {}
 
-  std::unique_ptr<BoundRootNode> Binder::bind(RootNode &root)
+  std::unique_ptr<BoundRootNode> Binder::bind(RootNode &root, unsigned threads)
   {
+    types_ = std::make_shared<zir::TypeContext>();
     boundRoot_ = std::make_unique<BoundRootNode>();
-    currentScope_ = std::make_shared<SymbolTable>();
-    currentScope_->declare("Int", std::make_shared<TypeSymbol>(
-                                      "Int", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::Int)));
-    currentScope_->declare("Int8", std::make_shared<TypeSymbol>(
-                                      "Int8", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::Int8)));
-    currentScope_->declare("Int16", std::make_shared<TypeSymbol>(
-                                      "Int16", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::Int16)));
-    currentScope_->declare("Int32", std::make_shared<TypeSymbol>(
-                                      "Int32", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::Int32)));
-    currentScope_->declare("Int64", std::make_shared<TypeSymbol>(
-                                      "Int64", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::Int64)));
-    currentScope_->declare("UInt", std::make_shared<TypeSymbol>(
-                                      "UInt", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::UInt)));
-    currentScope_->declare("UInt8", std::make_shared<TypeSymbol>(
-                                      "UInt8", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::UInt8)));
-    currentScope_->declare("UInt16", std::make_shared<TypeSymbol>(
-                                      "UInt16", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::UInt16)));
-    currentScope_->declare("UInt32", std::make_shared<TypeSymbol>(
-                                      "UInt32", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::UInt32)));
-    currentScope_->declare("UInt64", std::make_shared<TypeSymbol>(
-                                      "UInt64", std::make_shared<zir::PrimitiveType>(
-                                                 zir::TypeKind::UInt64)));
-    currentScope_->declare(
+    boundRoot_->types = types_;
+    symbols_ = SymbolTable();
+    symbols_.declare("Int", std::make_shared<TypeSymbol>(
+                                      "Int", types_->getPrimitive(zir::TypeKind::Int)));
+    symbols_.declare("Int8", std::make_shared<TypeSymbol>(
+                                      "Int8", types_->getPrimitive(zir::TypeKind::Int8)));
+    symbols_.declare("Int16", std::make_shared<TypeSymbol>(
+                                      "Int16", types_->getPrimitive(zir::TypeKind::Int16)));
+    symbols_.declare("Int32", std::make_shared<TypeSymbol>(
+                                      "Int32", types_->getPrimitive(zir::TypeKind::Int32)));
+    symbols_.declare("Int64", std::make_shared<TypeSymbol>(
+                                      "Int64", types_->getPrimitive(zir::TypeKind::Int64)));
+    symbols_.declare("UInt", std::make_shared<TypeSymbol>(
+                                      "UInt", types_->getPrimitive(zir::TypeKind::UInt)));
+    symbols_.declare("UInt8", std::make_shared<TypeSymbol>(
+                                      "UInt8", types_->getPrimitive(zir::TypeKind::UInt8)));
+    symbols_.declare("UInt16", std::make_shared<TypeSymbol>(
+                                      "UInt16", types_->getPrimitive(zir::TypeKind::UInt16)));
+    symbols_.declare("UInt32", std::make_shared<TypeSymbol>(
+                                      "UInt32", types_->getPrimitive(zir::TypeKind::UInt32)));
+    symbols_.declare("UInt64", std::make_shared<TypeSymbol>(
+                                      "UInt64", types_->getPrimitive(zir::TypeKind::UInt64)));
+    symbols_.declare(
         "Float",
         std::make_shared<TypeSymbol>(
-            "Float", std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float)));
-    currentScope_->declare(
+            "Float", types_->getPrimitive(zir::TypeKind::Float)));
+    symbols_.declare(
         "Float32",
         std::make_shared<TypeSymbol>(
-            "Float32", std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float32)));
-    currentScope_->declare(
+            "Float32", types_->getPrimitive(zir::TypeKind::Float32)));
+    symbols_.declare(
         "Float64",
         std::make_shared<TypeSymbol>(
-            "Float64", std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float64)));
-    currentScope_->declare(
+            "Float64", types_->getPrimitive(zir::TypeKind::Float64)));
+    symbols_.declare(
         "Bool",
         std::make_shared<TypeSymbol>(
-            "Bool", std::make_shared<zir::PrimitiveType>(zir::TypeKind::Bool)));
-    currentScope_->declare(
+            "Bool", types_->getPrimitive(zir::TypeKind::Bool)));
+    symbols_.declare(
         "Void",
         std::make_shared<TypeSymbol>(
-            "Void", std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void)));
-    currentScope_->declare(
+            "Void", types_->getPrimitive(zir::TypeKind::Void)));
+    symbols_.declare(
         "String", std::make_shared<TypeSymbol>(
-                      "String", std::make_shared<zir::RecordType>("String")));
-    currentScope_->declare(
+                      "String", types_->getString()));
+    symbols_.declare(
       "Char",
       std::make_shared<TypeSymbol>(
-        "Char", std::make_shared<zir::PrimitiveType>(zir::TypeKind::Char)));
+        "Char", types_->getPrimitive(zir::TypeKind::Char)));
 
     {
       std::vector<std::shared_ptr<VariableSymbol>> params;
       params.push_back(
         std::make_shared<VariableSymbol>("s",
-                         std::make_shared<zir::RecordType>("String")));
-      auto retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+                         types_->getString()));
+      auto retType = types_->getPrimitive(zir::TypeKind::Void);
       auto symbol = std::make_shared<FunctionSymbol>("println", std::move(params), std::move(retType));
-      currentScope_->declare("println", symbol);
+      symbols_.declare("println", symbol);
       boundRoot_->externalFunctions.push_back(
         std::make_unique<BoundExternalFunctionDeclaration>(symbol));
     }
@@ -87,10 +86,10 @@ namespace sema
       std::vector<std::shared_ptr<VariableSymbol>> params;
       params.push_back(
         std::make_shared<VariableSymbol>("i",
-                         std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int)));
-      auto retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+                         types_->getPrimitive(zir::TypeKind::Int)));
+      auto retType = types_->getPrimitive(zir::TypeKind::Void);
       auto symbol = std::make_shared<FunctionSymbol>("printInt", std::move(params), std::move(retType));
-      currentScope_->declare("printInt", symbol);
+      symbols_.declare("printInt", symbol);
       boundRoot_->externalFunctions.push_back(
         std::make_unique<BoundExternalFunctionDeclaration>(symbol));
     }
@@ -99,10 +98,10 @@ namespace sema
       std::vector<std::shared_ptr<VariableSymbol>> params;
       params.push_back(
         std::make_shared<VariableSymbol>("b",
-                         std::make_shared<zir::PrimitiveType>(zir::TypeKind::Bool)));
-      auto retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+                         types_->getPrimitive(zir::TypeKind::Bool)));
+      auto retType = types_->getPrimitive(zir::TypeKind::Void);
       auto symbol = std::make_shared<FunctionSymbol>("printBool", std::move(params), std::move(retType));
-      currentScope_->declare("printBool", symbol);
+      symbols_.declare("printBool", symbol);
       boundRoot_->externalFunctions.push_back(
         std::make_unique<BoundExternalFunctionDeclaration>(symbol));
     }
@@ -111,10 +110,10 @@ namespace sema
       std::vector<std::shared_ptr<VariableSymbol>> params;
       params.push_back(
         std::make_shared<VariableSymbol>("f",
-                         std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float)));
-      auto retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+                         types_->getPrimitive(zir::TypeKind::Float)));
+      auto retType = types_->getPrimitive(zir::TypeKind::Void);
       auto symbol = std::make_shared<FunctionSymbol>("printFloat", std::move(params), std::move(retType));
-      currentScope_->declare("printFloat", symbol);
+      symbols_.declare("printFloat", symbol);
       boundRoot_->externalFunctions.push_back(
         std::make_unique<BoundExternalFunctionDeclaration>(symbol));
     }
@@ -123,20 +122,20 @@ namespace sema
       std::vector<std::shared_ptr<VariableSymbol>> params;
       params.push_back(
         std::make_shared<VariableSymbol>("f",
-                         std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float64)));
-      auto retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+                         types_->getPrimitive(zir::TypeKind::Float64)));
+      auto retType = types_->getPrimitive(zir::TypeKind::Void);
       auto symbol = std::make_shared<FunctionSymbol>("printFloat64", std::move(params), std::move(retType));
-      currentScope_->declare("printFloat64", symbol);
+      symbols_.declare("printFloat64", symbol);
       boundRoot_->externalFunctions.push_back(
         std::make_unique<BoundExternalFunctionDeclaration>(symbol));
     }
 
     for (const auto &child : root.children)
     {
-      if (auto recordDecl = dynamic_cast<RecordDecl *>(child.get()))
+      if (auto recordDecl = dyn_cast<RecordDecl>(child))
       {
-        auto type = std::make_shared<zir::RecordType>(recordDecl->name_);
-        if (!currentScope_->declare(recordDecl->name_,
+        auto type = types_->getRecord(recordDecl->name_);
+        if (!symbols_.declare(recordDecl->name_,
                                     std::make_shared<TypeSymbol>(
                                         recordDecl->name_, std::move(type))))
         {
@@ -144,10 +143,10 @@ namespace sema
                 "Type '" + recordDecl->name_ + "' already declared.");
         }
       }
-      else if (auto structDecl = dynamic_cast<StructDeclarationNode *>(child.get()))
+      else if (auto structDecl = dyn_cast<StructDeclarationNode>(child))
       {
-        auto type = std::make_shared<zir::RecordType>(structDecl->name_);
-        if (!currentScope_->declare(structDecl->name_,
+        auto type = types_->getRecord(structDecl->name_);
+        if (!symbols_.declare(structDecl->name_,
                                     std::make_shared<TypeSymbol>(
                                         structDecl->name_, std::move(type))))
         {
@@ -155,11 +154,13 @@ namespace sema
                 "Type '" + structDecl->name_ + "' already declared.");
         }
       }
-      else if (auto enumDecl = dynamic_cast<EnumDecl *>(child.get()))
+      else if (auto enumDecl = dyn_cast<EnumDecl>(child))
       {
-        auto type =
-            std::make_shared<zir::EnumType>(enumDecl->name_, enumDecl->entries_);
-        if (!currentScope_->declare(
+        auto type = std::make_shared<zir::EnumType>(
+            enumDecl->name_,
+            std::vector<zap::Identifier>(enumDecl->entries_.begin(),
+                                         enumDecl->entries_.end()));
+        if (!symbols_.declare(
                 enumDecl->name_,
                 std::make_shared<TypeSymbol>(enumDecl->name_, std::move(type))))
         {
@@ -171,7 +172,7 @@ namespace sema
 
     for (const auto &child : root.children)
     {
-      if (auto funDecl = dynamic_cast<FunDecl *>(child.get()))
+      if (auto funDecl = dyn_cast<FunDecl>(child))
       {
         std::vector<std::shared_ptr<VariableSymbol>> params;
         for (const auto &p : funDecl->params_)
@@ -186,22 +187,22 @@ namespace sema
         }
         else if (funDecl->name_ == "main")
         {
-          retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int);
+          retType = types_->getPrimitive(zir::TypeKind::Int);
         }
         else
         {
-          retType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+          retType = types_->getPrimitive(zir::TypeKind::Void);
         }
         auto symbol = std::make_shared<FunctionSymbol>(
             funDecl->name_, std::move(params), std::move(retType));
 
-        if (!currentScope_->declare(funDecl->name_, symbol))
+        if (!symbols_.declare(funDecl->name_, symbol))
         {
           error(funDecl->span,
                 "Function '" + funDecl->name_ + "' already declared.");
         }
       }
-      else if (auto extDecl = dynamic_cast<ExtDecl *>(child.get()))
+      else if (auto extDecl = dyn_cast<ExtDecl>(child))
       {
         std::vector<std::shared_ptr<VariableSymbol>> params;
         for (const auto &p : extDecl->params_)
@@ -212,11 +213,11 @@ namespace sema
         auto retType =
           extDecl->returnType_
             ? mapType(*extDecl->returnType_)
-            : std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+            : types_->getPrimitive(zir::TypeKind::Void);
         auto symbol = std::make_shared<FunctionSymbol>(
             extDecl->name_, std::move(params), std::move(retType));
 
-        if (!currentScope_->declare(extDecl->name_, symbol))
+        if (!symbols_.declare(extDecl->name_, symbol))
         {
           error(extDecl->span,
                 "External function '" + extDecl->name_ + "' already declared.");
@@ -224,10 +225,89 @@ namespace sema
       }
     }
 
-    root.accept(*this);
+    // A function only sees the globals declared before it, so the functions
+    // between two other declarations are bound together.
+    std::vector<FunDecl *> functions;
+    for (const auto &child : root.children)
+    {
+      if (auto funDecl = dyn_cast<FunDecl>(child))
+      {
+        functions.push_back(funDecl);
+        continue;
+      }
+      bindFunctions(functions, threads);
+      functions.clear();
+      child->accept(*this);
+    }
+    bindFunctions(functions, threads);
+
     return (hadError_ || _diag.hadErrors()) ? nullptr : std::move(boundRoot_);
   }
 
+  void Binder::bindFunctions(const std::vector<FunDecl *> &functions,
+                             unsigned threads)
+  {
+    size_t size = 0;
+    for (const FunDecl *funDecl : functions)
+    {
+      size += funDecl->span.length;
+    }
+
+    if (threads <= 1 || functions.size() < 2 || size < MIN_PARALLEL_SIZE)
+    {
+      for (FunDecl *funDecl : functions)
+      {
+        funDecl->accept(*this);
+      }
+      return;
+    }
+
+    // Every thread binds with a binder of its own, starting from a copy of
+    // the global scope. Diagnostics are buffered per function and reported
+    // in order afterwards, as if the functions were bound one by one.
+    std::vector<std::unique_ptr<BoundFunctionDeclaration>> bound(
+        functions.size());
+    std::vector<std::string> logs(functions.size());
+    std::vector<size_t> errors(functions.size(), 0);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]()
+    {
+      std::string buffer;
+      zap::StringStream log(buffer);
+      zap::DiagnosticEngine diag(_diag, log);
+      Binder binder(diag);
+      binder.symbols_ = symbols_;
+      binder.types_ = types_;
+      binder.boundRoot_ = std::make_unique<BoundRootNode>();
+
+      for (size_t i = next++; i < functions.size(); i = next++)
+      {
+        size_t before = diag.errors();
+        functions[i]->accept(binder);
+        auto &done = binder.boundRoot_->functions;
+        if (!done.empty())
+        {
+          bound[i] = std::move(done.back());
+          done.pop_back();
+        }
+        errors[i] = diag.errors() - before;
+        logs[i] = std::move(buffer);
+        buffer.clear();
+      }
+    };
+    zap::runOnThreads(std::min<size_t>(threads, functions.size()), worker);
+
+    for (size_t i = 0; i < functions.size(); ++i)
+    {
+      _diag.append(logs[i], errors[i]);
+      if (bound[i])
+      {
+        boundRoot_->functions.push_back(std::move(bound[i]));
+      }
+    }
+  }
+
   void Binder::visit(RootNode &node)
   {
     for (const auto &child : node.children)
@@ -239,7 +319,7 @@ namespace sema
   void Binder::visit(FunDecl &node)
   {
     auto symbol = std::dynamic_pointer_cast<FunctionSymbol>(
-        currentScope_->lookup(node.name_));
+        symbols_.lookup(node.name_));
     if (!symbol)
     {
       error(node.span,
@@ -247,13 +327,20 @@ namespace sema
       return;
     }
 
+    if (node.isBodySkipped())
+    {
+      error(node.span,
+            "Internal error: Body of " + node.name_ + " was never parsed");
+      return;
+    }
+
     pushScope();
     auto oldFunction = currentFunction_;
     currentFunction_ = symbol;
 
     for (const auto &param : symbol->parameters)
     {
-      if (!currentScope_->declare(param->name, param))
+      if (!symbols_.declare(param->name, param))
       {
         error(node.span, "Parameter '" + param->name + "' already declared.");
       }
@@ -293,8 +380,8 @@ namespace sema
     if (!hasReturn && symbol->name == "main" &&
         symbol->returnType->isInteger())
     {
-      auto intType = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int);
-      auto lit = std::make_unique<BoundLiteral>("0", intType);
+      auto intType = types_->getPrimitive(zir::TypeKind::Int);
+      auto lit = BoundLiteral::makeInteger(0, intType);
       boundBody->statements.push_back(
           std::make_unique<BoundReturnStatement>(std::move(lit)));
       hasReturn = true;
@@ -306,12 +393,8 @@ namespace sema
       if (symbol->returnType->isInteger() || kind == zir::TypeKind::Float ||
           kind == zir::TypeKind::Bool)
       {
-        std::string litVal = "0";
-        if (kind == zir::TypeKind::Float)
-          litVal = "0.0";
-        else if (kind == zir::TypeKind::Bool)
-          litVal = "false";
-        auto lit = std::make_unique<BoundLiteral>(litVal, symbol->returnType);
+        // Zero, 0.0 or false.
+        auto lit = std::make_unique<BoundLiteral>(symbol->returnType);
         boundBody->statements.push_back(
             std::make_unique<BoundReturnStatement>(std::move(lit)));
         hasReturn = true;
@@ -328,7 +411,7 @@ namespace sema
   void Binder::visit(ExtDecl &node)
   {
     auto symbol = std::dynamic_pointer_cast<FunctionSymbol>(
-        currentScope_->lookup(node.name_));
+        symbols_.lookup(node.name_));
     if (!symbol)
     {
       error(node.span,
@@ -402,7 +485,7 @@ namespace sema
     }
 
     auto symbol = std::make_shared<VariableSymbol>(node.name_, type);
-    if (!currentScope_->declare(node.name_, symbol))
+    if (!symbols_.declare(node.name_, symbol))
     {
       error(node.span, "Variable '" + node.name_ + "' already declared.");
     }
@@ -454,9 +537,10 @@ namespace sema
 
     auto symbol = std::make_shared<VariableSymbol>(node.name_, type, true);
     if (initializer) {
-      symbol->constant_value = std::shared_ptr<BoundExpression>(initializer->clone());
+      ConstantFolder().foldExpression(initializer);
+      symbol->constant_value = initializer.get();
     }
-    if (!currentScope_->declare(node.name_, symbol))
+    if (!symbols_.declare(node.name_, symbol))
     {
       error(node.span, "Identifier '" + node.name_ + "' already declared.");
     }
@@ -492,7 +576,7 @@ namespace sema
       auto expectedType = currentFunction_->returnType;
       auto actualType =
           expr ? expr->type
-               : std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+               : types_->getPrimitive(zir::TypeKind::Void);
       if (!canConvert(actualType, expectedType))
       {
         error(node.span, "Function '" + currentFunction_->name +
@@ -524,12 +608,18 @@ namespace sema
     expressionStack_.pop();
 
     auto type = left->type;
-    if (node.op_ == "+" || node.op_ == "-" || node.op_ == "*" ||
-        node.op_ == "/" || node.op_ == "%")
+    switch (node.op_)
+    {
+    case BinaryOp::Add:
+    case BinaryOp::Sub:
+    case BinaryOp::Mul:
+    case BinaryOp::Div:
+    case BinaryOp::Mod:
     {
       if (!isNumeric(left->type) || !isNumeric(right->type))
       {
-        error(node.span, "Operator '" + node.op_ +
+        error(node.span, std::string("Operator '") +
+                             binaryOpToString(node.op_) +
                              "' cannot be applied to types '" +
                              left->type->toString() + "' and '" +
                              right->type->toString() + "'");
@@ -537,26 +627,28 @@ namespace sema
       type = getPromotedType(left->type, right->type);
       left = wrapInCast(std::move(left), type);
       right = wrapInCast(std::move(right), type);
+      break;
     }
-    else if (node.op_ == "~")
+    case BinaryOp::Concat:
     {
-      auto isStringOrChar = [](std::shared_ptr<zir::Type> t) {
-        if (!t) return false;
-        if (t->getKind() == zir::TypeKind::Record)
-        {
-          return static_cast<zir::RecordType *>(t.get())->getName() == "String";
-        }
-        return t->getKind() == zir::TypeKind::Char;
+      auto isStringOrChar = [&](const std::shared_ptr<zir::Type> &t) {
+        return t && (t == types_->getString() ||
+                     t->getKind() == zir::TypeKind::Char);
       };
 
       if (!isStringOrChar(left->type) || !isStringOrChar(right->type))
       {
         error(node.span, "Operator '~' can only be applied to 'Char' and 'String' types");
       }
-      type = std::make_shared<zir::RecordType>("String");
+      type = types_->getString();
+      break;
     }
-    else if (node.op_ == "==" || node.op_ == "!=" || node.op_ == "<" ||
-             node.op_ == ">" || node.op_ == "<=" || node.op_ == ">=")
+    case BinaryOp::Equal:
+    case BinaryOp::NotEqual:
+    case BinaryOp::Less:
+    case BinaryOp::LessEqual:
+    case BinaryOp::Greater:
+    case BinaryOp::GreaterEqual:
     {
       if (!canConvert(left->type, right->type) &&
           !canConvert(right->type, left->type))
@@ -568,7 +660,13 @@ namespace sema
       auto commonType = getPromotedType(left->type, right->type);
       left = wrapInCast(std::move(left), commonType);
       right = wrapInCast(std::move(right), commonType);
-      type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Bool);
+      type = types_->getPrimitive(zir::TypeKind::Bool);
+      break;
+    }
+    case BinaryOp::Pow:
+    case BinaryOp::And:
+    case BinaryOp::Or:
+      break;
     }
 
     expressionStack_.push(std::make_unique<BoundBinaryExpression>(
@@ -577,33 +675,41 @@ namespace sema
 
   void Binder::visit(ConstInt &node)
   {
-    expressionStack_.push(std::make_unique<BoundLiteral>(
-        std::to_string(node.value_),
-        std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int)));
+    // Only literals too big for an Int are unsigned, like 0xFFFFFFFFFFFFFFFF.
+    auto kind = node.value_ > static_cast<uint64_t>(INT64_MAX)
+                    ? zir::TypeKind::UInt64
+                    : zir::TypeKind::Int;
+    expressionStack_.push(
+        BoundLiteral::makeInteger(node.value_, types_->getPrimitive(kind)));
   }
 
   void Binder::visit(ConstFloat &node)
   {
-    expressionStack_.push(std::make_unique<BoundLiteral>(
-        std::to_string(node.value_),
-        std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float)));
+    expressionStack_.push(BoundLiteral::makeFloat(
+        static_cast<float>(node.value_),
+        types_->getPrimitive(zir::TypeKind::Float)));
   }
 
   void Binder::visit(ConstString &node)
   {
-    expressionStack_.push(std::make_unique<BoundLiteral>(
-        node.value_, std::make_shared<zir::RecordType>("String")));
+    expressionStack_.push(BoundLiteral::makeString(
+        zap::Identifier(node.value_), types_->getString()));
   }
 
   void Binder::visit(ConstChar &node)
   {
-    expressionStack_.push(std::make_unique<BoundLiteral>(
-        node.value_, std::make_shared<zir::PrimitiveType>(zir::TypeKind::Char)));
+    // Chars are signed, so the byte is sign extended.
+    uint64_t value = node.value_.empty()
+                         ? 0
+                         : static_cast<uint64_t>(
+                               static_cast<signed char>(node.value_[0]));
+    expressionStack_.push(BoundLiteral::makeInteger(
+        value, types_->getPrimitive(zir::TypeKind::Char)));
   }
 
   void Binder::visit(ConstId &node)
   {
-    auto symbol = currentScope_->lookup(node.value_);
+    auto symbol = symbols_.lookup(node.value_);
     if (!symbol)
     {
       error(node.span, "Undefined identifier: " + node.value_);
@@ -616,7 +722,7 @@ namespace sema
     }
     else if (auto typeSymbol = std::dynamic_pointer_cast<TypeSymbol>(symbol))
     {
-      expressionStack_.push(std::make_unique<BoundLiteral>("", typeSymbol->type));
+      expressionStack_.push(std::make_unique<BoundLiteral>(typeSymbol->type));
     }
     else
     {
@@ -720,9 +826,7 @@ namespace sema
       int value = enumType->getVariantIndex(node.member_);
       if (value != -1)
       {
-        expressionStack_.push(std::make_unique<BoundLiteral>(
-            std::to_string(value),
-            enumType));
+        expressionStack_.push(BoundLiteral::makeInteger(value, enumType));
         return;
       }
     }
@@ -746,7 +850,7 @@ namespace sema
 
   void Binder::visit(FunCall &node)
   {
-    auto symbol = currentScope_->lookup(node.funcName_);
+    auto symbol = symbols_.lookup(node.funcName_);
     if (!symbol)
     {
       error(node.span, "Undefined function: " + node.funcName_);
@@ -771,7 +875,7 @@ namespace sema
     std::vector<std::unique_ptr<BoundExpression>> boundArgs;
     for (size_t i = 0; i < node.params_.size(); ++i)
     {
-      node.params_[i]->value->accept(*this);
+      node.params_[i].value->accept(*this);
       if (expressionStack_.empty())
         return;
       auto arg = std::move(expressionStack_.top());
@@ -838,7 +942,7 @@ namespace sema
     }
 
     std::shared_ptr<zir::Type> resultType =
-        std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+        types_->getPrimitive(zir::TypeKind::Void);
 
     if (thenBound && thenBound->result)
     {
@@ -943,77 +1047,24 @@ namespace sema
 
   void Binder::pushScope()
   {
-    currentScope_ = std::make_shared<SymbolTable>(currentScope_);
+    symbols_.pushScope();
   }
 
   void Binder::popScope()
   {
-    if (currentScope_)
-    {
-      currentScope_ = currentScope_->getParent();
-    }
+    symbols_.popScope();
   }
 
-  std::optional<int64_t> Binder::evaluateConstantInt(const BoundExpression *expr)
+  std::optional<int64_t>
+  Binder::evaluateConstantInt(std::unique_ptr<BoundExpression> &expr)
   {
-    if (!expr)
+    if (!ConstantFolder().foldExpression(expr) || !expr->type->isInteger())
       return std::nullopt;
 
-    if (auto literal = dynamic_cast<const BoundLiteral *>(expr))
-    {
-      try
-      {
-        return std::stoll(literal->value);
-      }
-      catch (...)
-      {
-        return std::nullopt;
-      }
-    }
-
-    if (auto varExpr = dynamic_cast<const BoundVariableExpression *>(expr))
-    {
-      if (varExpr->symbol->is_const && varExpr->symbol->constant_value)
-      {
-        return evaluateConstantInt(varExpr->symbol->constant_value.get());
-      }
-    }
-
-    if (auto cast = dynamic_cast<const BoundCast *>(expr))
-    {
-      return evaluateConstantInt(cast->expression.get());
-    }
-
-    if (auto binary = dynamic_cast<const BoundBinaryExpression *>(expr))
-    {
-      auto left = evaluateConstantInt(binary->left.get());
-      auto right = evaluateConstantInt(binary->right.get());
-      if (left && right)
-      {
-        if (binary->op == "+")
-          return *left + *right;
-        if (binary->op == "-")
-          return *left - *right;
-        if (binary->op == "*")
-          return *left * *right;
-        if (binary->op == "/")
-          return *right != 0 ? std::make_optional(*left / *right) : std::nullopt;
-      }
-    }
-
-    if (auto unary = dynamic_cast<const BoundUnaryExpression *>(expr))
-    {
-      auto val = evaluateConstantInt(unary->expr.get());
-      if (val)
-      {
-        if (unary->op == "-")
-          return -*val;
-        if (unary->op == "+")
-          return *val;
-      }
-    }
-
-    return std::nullopt;
+    auto value = static_cast<const BoundLiteral &>(*expr).integer;
+    if (expr->type->isUnsigned() && value > static_cast<uint64_t>(INT64_MAX))
+      return std::nullopt;
+    return static_cast<int64_t>(value);
   }
 
   std::shared_ptr<zir::Type> Binder::mapType(const TypeNode &typeNode)
@@ -1032,7 +1083,7 @@ namespace sema
         {
           auto boundSize = std::move(expressionStack_.top());
           expressionStack_.pop();
-          auto evaluated = evaluateConstantInt(boundSize.get());
+          auto evaluated = evaluateConstantInt(boundSize);
           if (evaluated)
           {
             size = static_cast<size_t>(*evaluated);
@@ -1044,7 +1095,7 @@ namespace sema
         }
       }
 
-      return std::make_shared<zir::ArrayType>(std::move(base), size);
+      return types_->getArray(base, size);
     }
 
     if (typeNode.isPointer)
@@ -1052,10 +1103,10 @@ namespace sema
       if (!typeNode.baseType)
         return nullptr;
       auto base = mapType(*typeNode.baseType);
-      return std::make_shared<zir::PointerType>(std::move(base));
+      return types_->getPointer(base);
     }
 
-    auto symbol = currentScope_->lookup(typeNode.typeName);
+    auto symbol = symbols_.lookup(typeNode.typeName);
     std::shared_ptr<zir::Type> type = nullptr;
 
     if (symbol && symbol->getKind() == SymbolKind::Type)
@@ -1065,41 +1116,41 @@ namespace sema
     else
     {
       if (typeNode.typeName == "Int")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int);
+        type = types_->getPrimitive(zir::TypeKind::Int);
       else if (typeNode.typeName == "Int8")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int8);
+        type = types_->getPrimitive(zir::TypeKind::Int8);
       else if (typeNode.typeName == "Int16")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int16);
+        type = types_->getPrimitive(zir::TypeKind::Int16);
       else if (typeNode.typeName == "Int32")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int32);
+        type = types_->getPrimitive(zir::TypeKind::Int32);
       else if (typeNode.typeName == "Int64")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Int64);
+        type = types_->getPrimitive(zir::TypeKind::Int64);
       else if (typeNode.typeName == "UInt")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::UInt);
+        type = types_->getPrimitive(zir::TypeKind::UInt);
       else if (typeNode.typeName == "UInt8")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::UInt8);
+        type = types_->getPrimitive(zir::TypeKind::UInt8);
       else if (typeNode.typeName == "UInt16")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::UInt16);
+        type = types_->getPrimitive(zir::TypeKind::UInt16);
       else if (typeNode.typeName == "UInt32")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::UInt32);
+        type = types_->getPrimitive(zir::TypeKind::UInt32);
       else if (typeNode.typeName == "UInt64")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::UInt64);
+        type = types_->getPrimitive(zir::TypeKind::UInt64);
       else if (typeNode.typeName == "Float")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float);
+        type = types_->getPrimitive(zir::TypeKind::Float);
       else if (typeNode.typeName == "Float32")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float32);
+        type = types_->getPrimitive(zir::TypeKind::Float32);
       else if (typeNode.typeName == "Float64")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float64);
+        type = types_->getPrimitive(zir::TypeKind::Float64);
       else if (typeNode.typeName == "Bool")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Bool);
+        type = types_->getPrimitive(zir::TypeKind::Bool);
       else if (typeNode.typeName == "String")
-        type = std::make_shared<zir::RecordType>("String");
+        type = types_->getString();
       else if (typeNode.typeName == "Char")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Char);
+        type = types_->getPrimitive(zir::TypeKind::Char);
       else if (typeNode.typeName == "Void")
-        type = std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void);
+        type = types_->getPrimitive(zir::TypeKind::Void);
       else
-        type = std::make_shared<zir::RecordType>(typeNode.typeName);
+        type = types_->getRecord(typeNode.typeName);
     }
 
     return type;
@@ -1107,9 +1158,8 @@ namespace sema
 
   void Binder::visit(ConstBool &node)
   {
-    expressionStack_.push(std::make_unique<BoundLiteral>(
-        node.value_ ? "true" : "false",
-        std::make_shared<zir::PrimitiveType>(zir::TypeKind::Bool)));
+    expressionStack_.push(BoundLiteral::makeInteger(
+        node.value_, types_->getPrimitive(zir::TypeKind::Bool)));
   }
 
   void Binder::visit(UnaryExpr &node)
@@ -1121,22 +1171,22 @@ namespace sema
     expressionStack_.pop();
 
     auto type = expr->type;
-    if (node.op_ == "-" || node.op_ == "+")
+    switch (node.op_)
     {
+    case UnaryOp::Negate:
       if (!isNumeric(type))
       {
-        error(node.span, "Operator '" + node.op_ +
-                             "' cannot be applied to type '" + type->toString() +
-                             "'");
+        error(node.span, "Operator '-' cannot be applied to type '" +
+                             type->toString() + "'");
       }
-    }
-    else if (node.op_ == "!")
-    {
+      break;
+    case UnaryOp::Not:
       if (type->getKind() != zir::TypeKind::Bool)
       {
         error(node.span, "Operator '!' cannot be applied to type '" +
                              type->toString() + "'");
       }
+      break;
     }
 
     expressionStack_.push(
@@ -1170,9 +1220,9 @@ namespace sema
       }
     }
 
-    auto arrayType = std::make_shared<zir::ArrayType>(
+    auto arrayType = types_->getArray(
         elementType ? elementType
-                    : std::make_shared<zir::PrimitiveType>(zir::TypeKind::Void),
+                    : types_->getPrimitive(zir::TypeKind::Void),
         elements.size());
     expressionStack_.push(
         std::make_unique<BoundArrayLiteral>(std::move(elements), arrayType));
@@ -1180,7 +1230,7 @@ namespace sema
 
   void Binder::visit(RecordDecl &node)
   {
-    auto symbol = currentScope_->lookup(node.name_);
+    auto symbol = symbols_.lookup(node.name_);
     auto recordType = std::static_pointer_cast<zir::RecordType>(symbol->type);
 
     for (const auto &field : node.fields_)
@@ -1195,7 +1245,7 @@ namespace sema
 
   void Binder::visit(StructDeclarationNode &node)
   {
-    auto symbol = currentScope_->lookup(node.name_);
+    auto symbol = symbols_.lookup(node.name_);
     auto recordType = std::static_pointer_cast<zir::RecordType>(symbol->type);
 
     for (const auto &field : node.fields_)
@@ -1210,7 +1260,7 @@ namespace sema
 
   void Binder::visit(StructLiteralNode &node)
   {
-    auto symbol = currentScope_->lookup(node.type_name_);
+    auto symbol = symbols_.lookup(node.type_name_);
     if (!symbol || symbol->getKind() != SymbolKind::Type)
     {
       error(node.span, "Unknown type: " + node.type_name_);
@@ -1225,7 +1275,7 @@ namespace sema
     }
 
     auto recordType = std::static_pointer_cast<zir::RecordType>(typeSymbol->type);
-    std::vector<std::pair<std::string, std::unique_ptr<BoundExpression>>> boundFields;
+    std::vector<std::pair<zap::Identifier, std::unique_ptr<BoundExpression>>> boundFields;
 
     for (auto &fieldInit : node.fields_)
     {
@@ -1293,7 +1343,7 @@ namespace sema
 
   void Binder::visit(EnumDecl &node)
   {
-    auto symbol = currentScope_->lookup(node.name_);
+    auto symbol = symbols_.lookup(node.name_);
     auto enumType = std::static_pointer_cast<zir::EnumType>(symbol->type);
 
     auto boundEnum = std::make_unique<BoundEnumDeclaration>();
@@ -1309,11 +1359,16 @@ namespace sema
   bool Binder::canConvert(std::shared_ptr<zir::Type> from,
                           std::shared_ptr<zir::Type> to)
   {
+    if (from == to)
+    {
+      return true;
+    }
+
     if (from->getKind() == to->getKind())
     {
       if (from->getKind() == zir::TypeKind::Record)
       {
-        return from->toString() == to->toString();
+        return false;
       }
       if (from->getKind() == zir::TypeKind::Array)
       {
@@ -1361,9 +1416,9 @@ namespace sema
       if (t1->getKind() == zir::TypeKind::Float64 ||
           t2->getKind() == zir::TypeKind::Float64)
       {
-        return std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float64);
+        return types_->getPrimitive(zir::TypeKind::Float64);
       }
-      return std::make_shared<zir::PrimitiveType>(zir::TypeKind::Float);
+      return types_->getPrimitive(zir::TypeKind::Float);
     }
 
     if (t1->isInteger() && t2->isInteger()) {
@@ -1393,7 +1448,7 @@ namespace sema
 
   std::unique_ptr<BoundExpression> Binder::wrapInCast(std::unique_ptr<BoundExpression> expr, std::shared_ptr<zir::Type> targetType)
   {
-    if (expr->type->getKind() == targetType->getKind() && expr->type->toString() == targetType->toString())
+    if (expr->type == targetType)
     {
       return expr;
     }
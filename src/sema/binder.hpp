@@ -15,7 +15,10 @@ namespace sema
   {
   public:
     Binder(zap::DiagnosticEngine &diag);
-    std::unique_ptr<BoundRootNode> bind(RootNode &root);
+
+    /// @brief Binds a whole file. Function bodies of big files are bound on
+    /// up to threads threads.
+    std::unique_ptr<BoundRootNode> bind(RootNode &root, unsigned threads = 1);
 
     void visit(RootNode &node) override;
     void visit(FunDecl &node) override;
@@ -48,7 +51,8 @@ namespace sema
 
   private:
     zap::DiagnosticEngine &_diag;
-    std::shared_ptr<SymbolTable> currentScope_;
+    SymbolTable symbols_;
+    std::shared_ptr<zir::TypeContext> types_;
     std::unique_ptr<BoundRootNode> boundRoot_;
 
     std::stack<std::unique_ptr<BoundExpression>> expressionStack_;
@@ -60,10 +64,16 @@ namespace sema
     void pushScope();
     void popScope();
 
+    /// @brief Binds consecutive functions, in parallel if they are big enough.
+    void bindFunctions(const std::vector<FunDecl *> &functions,
+                       unsigned threads);
+
     std::shared_ptr<FunctionSymbol> currentFunction_ = nullptr;
 
     std::shared_ptr<zir::Type> mapType(const TypeNode &typeNode);
-    std::optional<int64_t> evaluateConstantInt(const BoundExpression *expr);
+    /// @brief Folds expr, returns its value if it is a constant integer.
+    std::optional<int64_t>
+    evaluateConstantInt(std::unique_ptr<BoundExpression> &expr);
     std::unique_ptr<BoundExpression> wrapInCast(std::unique_ptr<BoundExpression> expr, std::shared_ptr<zir::Type> targetType);
     void error(SourceSpan span, const std::string &message);
 
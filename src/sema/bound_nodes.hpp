@@ -1,5 +1,6 @@
 #pragma once
-#include "../ir/type.hpp"
+#include "../ast/operators.hpp"
+#include "../ir/type_context.hpp"
 #include "symbol.hpp"
 #include <memory>
 #include <string>
@@ -76,13 +77,10 @@ namespace sema
   public:
     std::shared_ptr<zir::Type> type;
     explicit BoundExpression(std::shared_ptr<zir::Type> t) : type(std::move(t)) {}
-    virtual std::unique_ptr<BoundExpression> clone() const = 0;
   };
 
   class BoundStatement : public BoundNode
   {
-  public:
-    virtual std::unique_ptr<BoundStatement> cloneStatement() const = 0;
   };
 
   class BoundExpressionStatement : public BoundStatement
@@ -93,9 +91,6 @@ namespace sema
     explicit BoundExpressionStatement(std::unique_ptr<BoundExpression> expr)
         : expression(std::move(expr)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundExpressionStatement>(expression->clone());
-    }
   };
 
   class BoundBlock : public BoundStatement
@@ -104,28 +99,44 @@ namespace sema
     std::vector<std::unique_ptr<BoundStatement>> statements;
     std::unique_ptr<BoundExpression> result;
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      auto cloned = std::make_unique<BoundBlock>();
-      for (const auto &stmt : statements) cloned->statements.push_back(stmt->cloneStatement());
-      if (result) cloned->result = result->clone();
-      return cloned;
-    }
-    std::unique_ptr<BoundBlock> cloneBlock() const {
-      auto res = cloneStatement();
-      return std::unique_ptr<BoundBlock>(static_cast<BoundBlock *>(res.release()));
-    }
   };
 
+  /// @brief A constant, its type says which member holds the value. A
+  /// literal without a value names a type, like the enum of 'Color.Red'.
   class BoundLiteral : public BoundExpression
   {
   public:
-    std::string value;
-    BoundLiteral(std::string v, std::shared_ptr<zir::Type> t)
-        : BoundExpression(std::move(t)), value(std::move(v)) {}
-    void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundLiteral>(value, type);
+    /// @brief Integers, chars, enums and bools, sign or zero extended to 64
+    /// bits as their type says.
+    uint64_t integer = 0;
+    /// @brief Floats, rounded to the precision of their type.
+    double real = 0;
+    /// @brief Strings.
+    zap::Identifier string;
+
+    explicit BoundLiteral(std::shared_ptr<zir::Type> t)
+        : BoundExpression(std::move(t)) {}
+
+    static std::unique_ptr<BoundLiteral> makeInteger(uint64_t value,
+                                                     std::shared_ptr<zir::Type> t) {
+      auto literal = std::make_unique<BoundLiteral>(std::move(t));
+      literal->integer = value;
+      return literal;
+    }
+    static std::unique_ptr<BoundLiteral> makeFloat(double value,
+                                                   std::shared_ptr<zir::Type> t) {
+      auto literal = std::make_unique<BoundLiteral>(std::move(t));
+      literal->real = value;
+      return literal;
+    }
+    static std::unique_ptr<BoundLiteral> makeString(zap::Identifier value,
+                                                    std::shared_ptr<zir::Type> t) {
+      auto literal = std::make_unique<BoundLiteral>(std::move(t));
+      literal->string = value;
+      return literal;
     }
+
+    void accept(BoundVisitor &v) override { v.visit(*this); }
   };
 
   class BoundCast : public BoundExpression
@@ -135,9 +146,6 @@ namespace sema
     BoundCast(std::unique_ptr<BoundExpression> e, std::shared_ptr<zir::Type> t)
         : BoundExpression(std::move(t)), expression(std::move(e)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundCast>(expression->clone(), type);
-    }
   };
 
   class BoundVariableExpression : public BoundExpression
@@ -147,42 +155,33 @@ namespace sema
     explicit BoundVariableExpression(std::shared_ptr<VariableSymbol> s)
         : BoundExpression(s->type), symbol(std::move(s)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundVariableExpression>(symbol);
-    }
   };
 
   class BoundBinaryExpression : public BoundExpression
   {
   public:
     std::unique_ptr<BoundExpression> left;
-    std::string op;
+    BinaryOp op;
     std::unique_ptr<BoundExpression> right;
 
-    BoundBinaryExpression(std::unique_ptr<BoundExpression> l, std::string o,
+    BoundBinaryExpression(std::unique_ptr<BoundExpression> l, BinaryOp o,
                           std::unique_ptr<BoundExpression> r,
                           std::shared_ptr<zir::Type> t)
-        : BoundExpression(std::move(t)), left(std::move(l)), op(std::move(o)),
+        : BoundExpression(std::move(t)), left(std::move(l)), op(o),
           right(std::move(r)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundBinaryExpression>(left->clone(), op, right->clone(), type);
-    }
   };
 
   class BoundUnaryExpression : public BoundExpression
   {
   public:
-    std::string op;
+    UnaryOp op;
     std::unique_ptr<BoundExpression> expr;
 
-    BoundUnaryExpression(std::string o, std::unique_ptr<BoundExpression> e,
+    BoundUnaryExpression(UnaryOp o, std::unique_ptr<BoundExpression> e,
                          std::shared_ptr<zir::Type> t)
-        : BoundExpression(std::move(t)), op(std::move(o)), expr(std::move(e)) {}
+        : BoundExpression(std::move(t)), op(o), expr(std::move(e)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundUnaryExpression>(op, expr->clone(), type);
-    }
   };
 
   class BoundFunctionCall : public BoundExpression
@@ -196,11 +195,6 @@ namespace sema
         : BoundExpression(s->returnType), symbol(std::move(s)),
           arguments(std::move(args)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      std::vector<std::unique_ptr<BoundExpression>> clonedArgs;
-      for (const auto &arg : arguments) clonedArgs.push_back(arg->clone());
-      return std::make_unique<BoundFunctionCall>(symbol, std::move(clonedArgs));
-    }
   };
 
   class BoundArrayLiteral : public BoundExpression
@@ -211,11 +205,6 @@ namespace sema
                       std::shared_ptr<zir::Type> t)
         : BoundExpression(std::move(t)), elements(std::move(elems)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      std::vector<std::unique_ptr<BoundExpression>> clonedElems;
-      for (const auto &elem : elements) clonedElems.push_back(elem->clone());
-      return std::make_unique<BoundArrayLiteral>(std::move(clonedElems), type);
-    }
   };
 
   class BoundIndexAccess : public BoundExpression
@@ -229,9 +218,6 @@ namespace sema
                      std::shared_ptr<zir::Type> t)
         : BoundExpression(std::move(t)), left(std::move(l)), index(std::move(i)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundIndexAccess>(left->clone(), index->clone(), type);
-    }
   };
 
 
@@ -245,9 +231,6 @@ namespace sema
                              std::unique_ptr<BoundExpression> init)
         : symbol(std::move(s)), initializer(std::move(init)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundVariableDeclaration>(symbol, initializer ? initializer->clone() : nullptr);
-    }
   };
 
   class BoundReturnStatement : public BoundStatement
@@ -257,9 +240,6 @@ namespace sema
     explicit BoundReturnStatement(std::unique_ptr<BoundExpression> e)
         : expression(std::move(e)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundReturnStatement>(expression ? expression->clone() : nullptr);
-    }
   };
 
   class BoundAssignment : public BoundStatement
@@ -272,9 +252,6 @@ namespace sema
                     std::unique_ptr<BoundExpression> e)
         : target(std::move(t)), expression(std::move(e)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundAssignment>(target->clone(), expression->clone());
-    }
   };
 
   class BoundIfExpression : public BoundExpression, public BoundStatement
@@ -291,14 +268,6 @@ namespace sema
         : BoundExpression(std::move(t)), condition(std::move(cond)),
           thenBody(std::move(thenB)), elseBody(std::move(elseB)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundIfExpression>(condition->clone(), thenBody->cloneBlock(), elseBody ? elseBody->cloneBlock() : nullptr, type);
-    }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      auto clonedExpr = clone();
-      auto *ptr = clonedExpr.release();
-      return std::unique_ptr<BoundStatement>(dynamic_cast<BoundStatement *>(ptr));
-    }
   };
 
   class BoundWhileStatement : public BoundStatement
@@ -311,9 +280,6 @@ namespace sema
                         std::unique_ptr<BoundBlock> b)
         : condition(std::move(cond)), body(std::move(b)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundWhileStatement>(condition->clone(), body->cloneBlock());
-    }
   };
 
   class BoundBreakStatement : public BoundStatement
@@ -321,9 +287,6 @@ namespace sema
   public:
     BoundBreakStatement() = default;
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundBreakStatement>();
-    }
   };
 
   class BoundContinueStatement : public BoundStatement
@@ -331,9 +294,6 @@ namespace sema
   public:
     BoundContinueStatement() = default;
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundStatement> cloneStatement() const override {
-      return std::make_unique<BoundContinueStatement>();
-    }
   };
 
 
@@ -377,33 +337,23 @@ namespace sema
   {
   public:
     std::unique_ptr<BoundExpression> left;
-    std::string member;
+    zap::Identifier member;
 
-    BoundMemberAccess(std::unique_ptr<BoundExpression> l, std::string m,
+    BoundMemberAccess(std::unique_ptr<BoundExpression> l, zap::Identifier m,
                       std::shared_ptr<zir::Type> t)
-        : BoundExpression(std::move(t)), left(std::move(l)), member(std::move(m)) {}
+        : BoundExpression(std::move(t)), left(std::move(l)), member(m) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      return std::make_unique<BoundMemberAccess>(left->clone(), member, type);
-    }
   };
 
   class BoundStructLiteral : public BoundExpression
   {
   public:
-    std::vector<std::pair<std::string, std::unique_ptr<BoundExpression>>> fields;
+    std::vector<std::pair<zap::Identifier, std::unique_ptr<BoundExpression>>> fields;
 
-    BoundStructLiteral(std::vector<std::pair<std::string, std::unique_ptr<BoundExpression>>> f,
+    BoundStructLiteral(std::vector<std::pair<zap::Identifier, std::unique_ptr<BoundExpression>>> f,
                        std::shared_ptr<zir::Type> t)
         : BoundExpression(std::move(t)), fields(std::move(f)) {}
     void accept(BoundVisitor &v) override { v.visit(*this); }
-    std::unique_ptr<BoundExpression> clone() const override {
-      std::vector<std::pair<std::string, std::unique_ptr<BoundExpression>>> clonedFields;
-      for (const auto &field : fields) {
-        clonedFields.push_back({field.first, field.second->clone()});
-      }
-      return std::make_unique<BoundStructLiteral>(std::move(clonedFields), type);
-    }
   };
 
   class BoundRootNode : public BoundNode
@@ -415,6 +365,8 @@ namespace sema
     std::vector<std::unique_ptr<BoundFunctionDeclaration>> functions;
     std::vector<std::unique_ptr<BoundExternalFunctionDeclaration>>
         externalFunctions;
+    /// @brief Owns the types of the tree, equal types are the same object.
+    std::shared_ptr<zir::TypeContext> types;
     void accept(BoundVisitor &v) override { v.visit(*this); }
   };
 
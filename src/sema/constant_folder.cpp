@@ -0,0 +1,709 @@
+#include "constant_folder.hpp"
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+namespace sema
+{
+
+  namespace
+  {
+
+    /// @brief Value of a literal. Integers, chars and enums are kept sign or
+    /// zero extended to 64 bits, as their type says.
+    struct Constant
+    {
+      enum class Kind
+      {
+        Integer,
+        Float,
+        Bool,
+        String,
+      };
+
+      Kind kind = Kind::Integer;
+      uint64_t bits = 0;
+      double real = 0;
+      std::string text;
+    };
+
+    /// @brief Returns the width of an integer, char or enum type, 0 for
+    /// other types.
+    unsigned integerWidth(const zir::Type &type)
+    {
+      switch (type.getKind())
+      {
+      case zir::TypeKind::Int8:
+      case zir::TypeKind::UInt8:
+      case zir::TypeKind::Char:
+        return 8;
+      case zir::TypeKind::Int16:
+      case zir::TypeKind::UInt16:
+        return 16;
+      case zir::TypeKind::Int32:
+      case zir::TypeKind::UInt32:
+        return 32;
+      case zir::TypeKind::Int:
+      case zir::TypeKind::UInt:
+      case zir::TypeKind::Int64:
+      case zir::TypeKind::UInt64:
+      case zir::TypeKind::Enum:
+        return 64;
+      default:
+        return 0;
+      }
+    }
+
+    bool isDouble(const zir::Type &type)
+    {
+      return type.getKind() == zir::TypeKind::Float64;
+    }
+
+    bool isString(const zir::Type &type)
+    {
+      return type.getKind() == zir::TypeKind::Record &&
+             static_cast<const zir::RecordType &>(type).getName() == "String";
+    }
+
+    /// @brief Truncates value to the width of type, then extends it back.
+    uint64_t wrap(uint64_t value, const zir::Type &type)
+    {
+      unsigned width = integerWidth(type);
+      if (width == 0 || width == 64)
+        return value;
+
+      uint64_t mask = (uint64_t(1) << width) - 1;
+      value &= mask;
+      if (!type.isUnsigned() && (value >> (width - 1)) != 0)
+        value |= ~mask;
+      return value;
+    }
+
+    /// @brief Rounds value to the precision of the floating point type.
+    double roundTo(double value, const zir::Type &type)
+    {
+      return isDouble(type) ? value : static_cast<double>(static_cast<float>(value));
+    }
+
+    std::optional<Constant> read(const BoundLiteral &literal)
+    {
+      const zir::Type &type = *literal.type;
+      Constant constant;
+
+      if (type.getKind() == zir::TypeKind::Bool)
+      {
+        constant.kind = Constant::Kind::Bool;
+        constant.bits = literal.integer;
+        return constant;
+      }
+      if (integerWidth(type) != 0)
+      {
+        constant.bits = literal.integer;
+        return constant;
+      }
+      if (type.isFloatingPoint())
+      {
+        constant.kind = Constant::Kind::Float;
+        constant.real = literal.real;
+        return constant;
+      }
+      if (isString(type))
+      {
+        constant.kind = Constant::Kind::String;
+        constant.text = literal.string.str();
+        return constant;
+      }
+      return std::nullopt;
+    }
+
+    std::unique_ptr<BoundExpression> write(const Constant &constant,
+                                           const std::shared_ptr<zir::Type> &type)
+    {
+      switch (constant.kind)
+      {
+      case Constant::Kind::Integer:
+      case Constant::Kind::Bool:
+        return BoundLiteral::makeInteger(constant.bits, type);
+      case Constant::Kind::Float:
+        return BoundLiteral::makeFloat(constant.real, type);
+      case Constant::Kind::String:
+        return BoundLiteral::makeString(zap::Identifier(constant.text), type);
+      }
+      return nullptr;
+    }
+
+    std::optional<Constant> literalValue(const BoundExpression &expr)
+    {
+      if (auto literal = dynamic_cast<const BoundLiteral *>(&expr))
+        return read(*literal);
+      return std::nullopt;
+    }
+
+    std::optional<bool> conditionValue(const BoundExpression &expr)
+    {
+      auto value = literalValue(expr);
+      if (!value || value->kind != Constant::Kind::Bool)
+        return std::nullopt;
+      return value->bits != 0;
+    }
+
+    std::optional<Constant> evaluate(BinaryOp op, const Constant &left,
+                                     const Constant &right,
+                                     const zir::Type &operandType,
+                                     const zir::Type &resultType)
+    {
+      Constant result;
+
+      if (op == BinaryOp::Concat)
+      {
+        // Chars are integers here, their one byte is appended.
+        auto text = [](const Constant &c) {
+          return c.kind == Constant::Kind::String
+                     ? c.text
+                     : std::string(1, static_cast<char>(c.bits));
+        };
+        result.kind = Constant::Kind::String;
+        result.text = text(left) + text(right);
+        return result;
+      }
+
+      if (left.kind != right.kind)
+        return std::nullopt;
+
+      result.kind = Constant::Kind::Bool;
+      switch (left.kind)
+      {
+      case Constant::Kind::Bool:
+        switch (op)
+        {
+        case BinaryOp::And:
+          result.bits = left.bits && right.bits;
+          return result;
+        case BinaryOp::Or:
+          result.bits = left.bits || right.bits;
+          return result;
+        case BinaryOp::Equal:
+          result.bits = left.bits == right.bits;
+          return result;
+        case BinaryOp::NotEqual:
+          result.bits = left.bits != right.bits;
+          return result;
+        default:
+          return std::nullopt;
+        }
+
+      case Constant::Kind::Integer:
+      {
+        bool isSigned = !operandType.isUnsigned();
+        int64_t sl = static_cast<int64_t>(left.bits);
+        int64_t sr = static_cast<int64_t>(right.bits);
+        uint64_t ul = left.bits;
+        uint64_t ur = right.bits;
+
+        switch (op)
+        {
+        case BinaryOp::Equal:
+          result.bits = ul == ur;
+          return result;
+        case BinaryOp::NotEqual:
+          result.bits = ul != ur;
+          return result;
+        case BinaryOp::Less:
+          result.bits = isSigned ? sl < sr : ul < ur;
+          return result;
+        case BinaryOp::LessEqual:
+          result.bits = isSigned ? sl <= sr : ul <= ur;
+          return result;
+        case BinaryOp::Greater:
+          result.bits = isSigned ? sl > sr : ul > ur;
+          return result;
+        case BinaryOp::GreaterEqual:
+          result.bits = isSigned ? sl >= sr : ul >= ur;
+          return result;
+        default:
+          break;
+        }
+
+        result.kind = Constant::Kind::Integer;
+        switch (op)
+        {
+        case BinaryOp::Add:
+          result.bits = wrap(ul + ur, resultType);
+          return result;
+        case BinaryOp::Sub:
+          result.bits = wrap(ul - ur, resultType);
+          return result;
+        case BinaryOp::Mul:
+          result.bits = wrap(ul * ur, resultType);
+          return result;
+        case BinaryOp::Div:
+        case BinaryOp::Mod:
+        {
+          if (ur == 0)
+            return std::nullopt;
+          if (isSigned)
+          {
+            // The smallest value divided by -1 overflows, which is undefined.
+            uint64_t smallest =
+                wrap(uint64_t(1) << (integerWidth(operandType) - 1), operandType);
+            if (sr == -1 && ul == smallest)
+              return std::nullopt;
+            result.bits = static_cast<uint64_t>(op == BinaryOp::Div ? sl / sr
+                                                                    : sl % sr);
+          }
+          else
+          {
+            result.bits = op == BinaryOp::Div ? ul / ur : ul % ur;
+          }
+          result.bits = wrap(result.bits, resultType);
+          return result;
+        }
+        default:
+          return std::nullopt;
+        }
+      }
+
+      case Constant::Kind::Float:
+      {
+        double l = left.real;
+        double r = right.real;
+
+        // Comparisons are ordered, anything involving NaN is false.
+        switch (op)
+        {
+        case BinaryOp::Equal:
+          result.bits = l == r;
+          return result;
+        case BinaryOp::NotEqual:
+          result.bits = !std::isnan(l) && !std::isnan(r) && l != r;
+          return result;
+        case BinaryOp::Less:
+          result.bits = l < r;
+          return result;
+        case BinaryOp::LessEqual:
+          result.bits = l <= r;
+          return result;
+        case BinaryOp::Greater:
+          result.bits = l > r;
+          return result;
+        case BinaryOp::GreaterEqual:
+          result.bits = l >= r;
+          return result;
+        default:
+          break;
+        }
+
+        // Doubles are wide enough that rounding their result to a float
+        // gives the float operation's result.
+        result.kind = Constant::Kind::Float;
+        switch (op)
+        {
+        case BinaryOp::Add:
+          result.real = roundTo(l + r, resultType);
+          return result;
+        case BinaryOp::Sub:
+          result.real = roundTo(l - r, resultType);
+          return result;
+        case BinaryOp::Mul:
+          result.real = roundTo(l * r, resultType);
+          return result;
+        case BinaryOp::Div:
+          result.real = roundTo(l / r, resultType);
+          return result;
+        case BinaryOp::Mod:
+          result.real = roundTo(std::fmod(l, r), resultType);
+          return result;
+        default:
+          return std::nullopt;
+        }
+      }
+
+      case Constant::Kind::String:
+        return std::nullopt;
+      }
+      return std::nullopt;
+    }
+
+    std::optional<Constant> evaluate(UnaryOp op, const Constant &operand,
+                                     const zir::Type &type)
+    {
+      Constant result = operand;
+      switch (operand.kind)
+      {
+      case Constant::Kind::Integer:
+        result.bits = wrap(op == UnaryOp::Negate ? 0 - operand.bits : ~operand.bits,
+                           type);
+        return result;
+      case Constant::Kind::Float:
+        if (op != UnaryOp::Negate)
+          return std::nullopt;
+        result.real = -operand.real;
+        return result;
+      case Constant::Kind::Bool:
+        if (op != UnaryOp::Not)
+          return std::nullopt;
+        result.bits = !operand.bits;
+        return result;
+      case Constant::Kind::String:
+        return std::nullopt;
+      }
+      return std::nullopt;
+    }
+
+    /// @brief Converts like the code generators' casts, bools and strings
+    /// aren't converted.
+    std::optional<Constant> convert(const Constant &value, const zir::Type &from,
+                                    const zir::Type &to)
+    {
+      Constant result;
+      unsigned width = integerWidth(to);
+
+      if (value.kind == Constant::Kind::Integer)
+      {
+        if (width != 0)
+        {
+          result.bits = wrap(value.bits, to);
+          return result;
+        }
+        if (to.isFloatingPoint())
+        {
+          result.kind = Constant::Kind::Float;
+          if (isDouble(to))
+            result.real = from.isUnsigned()
+                              ? static_cast<double>(value.bits)
+                              : static_cast<double>(static_cast<int64_t>(value.bits));
+          else
+            result.real = from.isUnsigned()
+                              ? static_cast<float>(value.bits)
+                              : static_cast<float>(static_cast<int64_t>(value.bits));
+          return result;
+        }
+        return std::nullopt;
+      }
+
+      if (value.kind == Constant::Kind::Float)
+      {
+        if (to.isFloatingPoint())
+        {
+          result.kind = Constant::Kind::Float;
+          result.real = roundTo(value.real, to);
+          return result;
+        }
+        if (width == 0 || std::isnan(value.real))
+          return std::nullopt;
+
+        // Values that don't fit the integer convert to poison.
+        double truncated = std::trunc(value.real);
+        if (to.isUnsigned())
+        {
+          if (truncated < 0 || truncated >= std::ldexp(1.0, width))
+            return std::nullopt;
+          result.bits = static_cast<uint64_t>(truncated);
+        }
+        else
+        {
+          if (truncated < -std::ldexp(1.0, width - 1) ||
+              truncated >= std::ldexp(1.0, width - 1))
+            return std::nullopt;
+          result.bits = static_cast<uint64_t>(static_cast<int64_t>(truncated));
+        }
+        result.bits = wrap(result.bits, to);
+        return result;
+      }
+
+      return std::nullopt;
+    }
+
+    /// @brief Returns whether the block leaves the code around it, statements
+    /// after it would be unreachable.
+    bool jumps(const BoundBlock &block)
+    {
+      for (const auto &stmt : block.statements)
+      {
+        if (dynamic_cast<const BoundReturnStatement *>(stmt.get()) ||
+            dynamic_cast<const BoundBreakStatement *>(stmt.get()) ||
+            dynamic_cast<const BoundContinueStatement *>(stmt.get()))
+          return true;
+        auto inner = dynamic_cast<const BoundBlock *>(stmt.get());
+        if (inner && jumps(*inner))
+          return true;
+      }
+      return false;
+    }
+
+  } // namespace
+
+  void ConstantFolder::fold(BoundRootNode &root)
+  {
+    root.accept(*this);
+  }
+
+  bool ConstantFolder::foldExpression(std::unique_ptr<BoundExpression> &expr)
+  {
+    if (!expr)
+      return false;
+
+    expr->accept(*this);
+    if (replacement_)
+    {
+      expr = std::move(replacement_);
+    }
+    return dynamic_cast<const BoundLiteral *>(expr.get()) != nullptr;
+  }
+
+  void ConstantFolder::foldAddress(std::unique_ptr<BoundExpression> &expr)
+  {
+    if (dynamic_cast<const BoundVariableExpression *>(expr.get()))
+      return;
+    foldExpression(expr);
+  }
+
+  void ConstantFolder::visit(BoundRootNode &node)
+  {
+    for (const auto &global : node.globals)
+    {
+      global->accept(*this);
+    }
+    for (const auto &function : node.functions)
+    {
+      function->accept(*this);
+    }
+  }
+
+  void ConstantFolder::visit(BoundFunctionDeclaration &node)
+  {
+    if (node.body)
+      node.body->accept(*this);
+  }
+
+  void ConstantFolder::visit(BoundExternalFunctionDeclaration &) {}
+
+  void ConstantFolder::visit(BoundBlock &node)
+  {
+    std::vector<std::unique_ptr<BoundStatement>> statements;
+    statements.reserve(node.statements.size());
+
+    for (auto &stmt : node.statements)
+    {
+      stmt->accept(*this);
+
+      if (auto ifStmt = dynamic_cast<BoundIfExpression *>(stmt.get()))
+      {
+        auto condition = conditionValue(*ifStmt->condition);
+        if (condition)
+        {
+          auto taken = std::move(*condition ? ifStmt->thenBody : ifStmt->elseBody);
+          if (!taken)
+            continue;
+
+          // A branch that jumps away keeps its if, which gives the code after
+          // it a block of its own.
+          if (!jumps(*taken))
+          {
+            statements.push_back(std::move(taken));
+            continue;
+          }
+          if (!*condition)
+          {
+            ifStmt->condition =
+                BoundLiteral::makeInteger(1, ifStmt->condition->type);
+          }
+          ifStmt->thenBody = std::move(taken);
+          ifStmt->elseBody = nullptr;
+        }
+      }
+      else if (auto whileStmt = dynamic_cast<BoundWhileStatement *>(stmt.get()))
+      {
+        auto condition = conditionValue(*whileStmt->condition);
+        if (condition && !*condition)
+          continue;
+      }
+
+      statements.push_back(std::move(stmt));
+    }
+
+    node.statements = std::move(statements);
+    if (node.result)
+      foldExpression(node.result);
+  }
+
+  void ConstantFolder::visit(BoundVariableDeclaration &node)
+  {
+    if (!node.initializer)
+      return;
+
+    foldExpression(node.initializer);
+    if (node.symbol->is_const)
+      node.symbol->constant_value = node.initializer.get();
+  }
+
+  void ConstantFolder::visit(BoundReturnStatement &node)
+  {
+    if (node.expression)
+      foldExpression(node.expression);
+  }
+
+  void ConstantFolder::visit(BoundAssignment &node)
+  {
+    foldAddress(node.target);
+    foldExpression(node.expression);
+  }
+
+  void ConstantFolder::visit(BoundExpressionStatement &node)
+  {
+    foldExpression(node.expression);
+  }
+
+  void ConstantFolder::visit(BoundLiteral &) {}
+
+  void ConstantFolder::visit(BoundVariableExpression &node)
+  {
+    if (!node.symbol->is_const)
+      return;
+
+    // The binder folds constant initializers, so a constant that can be
+    // folded has a literal value.
+    auto literal = dynamic_cast<const BoundLiteral *>(node.symbol->constant_value);
+    if (literal && read(*literal))
+      replacement_ = std::make_unique<BoundLiteral>(*literal);
+  }
+
+  void ConstantFolder::visit(BoundBinaryExpression &node)
+  {
+    bool left = foldExpression(node.left);
+
+    // A constant left side of && and || either decides the result or leaves
+    // it to the right side.
+    if (left && (node.op == BinaryOp::And || node.op == BinaryOp::Or))
+    {
+      auto value = conditionValue(*node.left);
+      if (value)
+      {
+        if (*value == (node.op == BinaryOp::Or))
+        {
+          replacement_ = std::move(node.left);
+        }
+        else
+        {
+          foldExpression(node.right);
+          replacement_ = std::move(node.right);
+        }
+        return;
+      }
+    }
+
+    bool right = foldExpression(node.right);
+    if (!left || !right)
+      return;
+
+    auto l = literalValue(*node.left);
+    auto r = literalValue(*node.right);
+    if (!l || !r)
+      return;
+
+    auto result = evaluate(node.op, *l, *r, *node.left->type, *node.type);
+    if (result)
+      replacement_ = write(*result, node.type);
+  }
+
+  void ConstantFolder::visit(BoundUnaryExpression &node)
+  {
+    if (!foldExpression(node.expr))
+      return;
+
+    auto value = literalValue(*node.expr);
+    if (!value)
+      return;
+
+    auto result = evaluate(node.op, *value, *node.type);
+    if (result)
+      replacement_ = write(*result, node.type);
+  }
+
+  void ConstantFolder::visit(BoundFunctionCall &node)
+  {
+    for (auto &arg : node.arguments)
+    {
+      foldExpression(arg);
+    }
+  }
+
+  void ConstantFolder::visit(BoundArrayLiteral &node)
+  {
+    for (auto &elem : node.elements)
+    {
+      foldExpression(elem);
+    }
+  }
+
+  void ConstantFolder::visit(BoundIndexAccess &node)
+  {
+    foldAddress(node.left);
+    foldExpression(node.index);
+  }
+
+  void ConstantFolder::visit(BoundRecordDeclaration &) {}
+
+  void ConstantFolder::visit(BoundEnumDeclaration &) {}
+
+  void ConstantFolder::visit(BoundMemberAccess &node)
+  {
+    foldAddress(node.left);
+  }
+
+  void ConstantFolder::visit(BoundStructLiteral &node)
+  {
+    for (auto &field : node.fields)
+    {
+      foldExpression(field.second);
+    }
+  }
+
+  void ConstantFolder::visit(BoundIfExpression &node)
+  {
+    foldExpression(node.condition);
+    if (node.thenBody)
+      node.thenBody->accept(*this);
+    if (node.elseBody)
+      node.elseBody->accept(*this);
+
+    // If statements are pruned by their block, an if expression can only be
+    // replaced by a branch that is nothing but its result.
+    if (node.type->getKind() == zir::TypeKind::Void)
+      return;
+
+    auto condition = conditionValue(*node.condition);
+    if (!condition)
+      return;
+
+    auto &taken = *condition ? node.thenBody : node.elseBody;
+    if (taken && taken->statements.empty() && taken->result)
+      replacement_ = std::move(taken->result);
+  }
+
+  void ConstantFolder::visit(BoundWhileStatement &node)
+  {
+    foldExpression(node.condition);
+    if (node.body)
+      node.body->accept(*this);
+  }
+
+  void ConstantFolder::visit(BoundBreakStatement &) {}
+
+  void ConstantFolder::visit(BoundContinueStatement &) {}
+
+  void ConstantFolder::visit(BoundCast &node)
+  {
+    if (!foldExpression(node.expression))
+      return;
+
+    auto value = literalValue(*node.expression);
+    if (!value)
+      return;
+
+    auto result = convert(*value, *node.expression->type, *node.type);
+    if (result)
+      replacement_ = write(*result, node.type);
+  }
+
+} // namespace sema
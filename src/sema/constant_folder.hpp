@@ -0,0 +1,57 @@
+#pragma once
+#include "bound_nodes.hpp"
+#include <memory>
+
+namespace sema
+{
+
+  /// @brief Replaces the constant expressions of a bound tree by literals and
+  /// drops the branches of ifs and loops whose condition is constant.
+  ///
+  /// Integers wrap to the width of their type like they do at run time,
+  /// operations without a defined result, like a division by zero, are left
+  /// for the program to execute.
+  class ConstantFolder : public BoundVisitor
+  {
+  public:
+    /// @brief Folds the global initializers and function bodies of root.
+    void fold(BoundRootNode &root);
+
+    /// @brief Folds expr in place.
+    /// @return Whether expr is a literal now.
+    bool foldExpression(std::unique_ptr<BoundExpression> &expr);
+
+    void visit(BoundRootNode &node) override;
+    void visit(BoundFunctionDeclaration &node) override;
+    void visit(BoundExternalFunctionDeclaration &node) override;
+    void visit(BoundBlock &node) override;
+    void visit(BoundVariableDeclaration &node) override;
+    void visit(BoundReturnStatement &node) override;
+    void visit(BoundAssignment &node) override;
+    void visit(BoundExpressionStatement &node) override;
+    void visit(BoundLiteral &node) override;
+    void visit(BoundVariableExpression &node) override;
+    void visit(BoundBinaryExpression &node) override;
+    void visit(BoundUnaryExpression &node) override;
+    void visit(BoundFunctionCall &node) override;
+    void visit(BoundArrayLiteral &node) override;
+    void visit(BoundIndexAccess &node) override;
+    void visit(BoundRecordDeclaration &node) override;
+    void visit(BoundEnumDeclaration &node) override;
+    void visit(BoundMemberAccess &node) override;
+    void visit(BoundStructLiteral &node) override;
+    void visit(BoundIfExpression &node) override;
+    void visit(BoundWhileStatement &node) override;
+    void visit(BoundBreakStatement &node) override;
+    void visit(BoundContinueStatement &node) override;
+    void visit(BoundCast &node) override;
+
+  private:
+    /// @brief Set by the visit of an expression that folds to another one.
+    std::unique_ptr<BoundExpression> replacement_;
+
+    /// @brief Folds an expression whose address is taken, so variables stay.
+    void foldAddress(std::unique_ptr<BoundExpression> &expr);
+  };
+
+} // namespace sema
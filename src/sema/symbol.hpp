@@ -1,5 +1,6 @@
 #pragma once
 #include "../ir/type.hpp"
+#include "../utils/identifier.hpp"
 #include <memory>
 #include <string>
 #include <vector>
@@ -12,22 +13,24 @@ class BoundExpression;
 
 class Symbol {
 public:
-  std::string name;
+  zap::Identifier name;
   std::shared_ptr<zir::Type> type;
   virtual ~Symbol() noexcept = default;
   virtual SymbolKind getKind() const noexcept = 0;
 
 protected:
-  Symbol(std::string n, std::shared_ptr<zir::Type> t)
-      : name(std::move(n)), type(std::move(t)) {}
+  Symbol(zap::Identifier n, std::shared_ptr<zir::Type> t)
+      : name(n), type(std::move(t)) {}
 };
 
 class VariableSymbol : public Symbol {
 public:
   bool is_const = false;
-  std::shared_ptr<BoundExpression> constant_value = nullptr;
-  VariableSymbol(std::string n, std::shared_ptr<zir::Type> t, bool isConst = false)
-      : Symbol(std::move(n), std::move(t)), is_const(isConst) {}
+  /// @brief The folded initializer of a constant. It belongs to the
+  /// declaration, uses refer to it instead of copying it.
+  const BoundExpression *constant_value = nullptr;
+  VariableSymbol(zap::Identifier n, std::shared_ptr<zir::Type> t, bool isConst = false)
+      : Symbol(n, std::move(t)), is_const(isConst) {}
   SymbolKind getKind() const noexcept override { return SymbolKind::Variable; }
 };
 
@@ -36,10 +39,10 @@ public:
   std::vector<std::shared_ptr<VariableSymbol>> parameters;
   std::shared_ptr<zir::Type> returnType;
 
-  FunctionSymbol(std::string n,
+  FunctionSymbol(zap::Identifier n,
                  std::vector<std::shared_ptr<VariableSymbol>> params,
                  std::shared_ptr<zir::Type> retType)
-      : Symbol(std::move(n), nullptr), parameters(std::move(params)),
+      : Symbol(n, nullptr), parameters(std::move(params)),
         returnType(std::move(retType)) {}
 
   SymbolKind getKind() const noexcept override { return SymbolKind::Function; }
@@ -47,8 +50,8 @@ public:
 
 class TypeSymbol : public Symbol {
 public:
-  TypeSymbol(std::string n, std::shared_ptr<zir::Type> t)
-      : Symbol(std::move(n), std::move(t)) {}
+  TypeSymbol(zap::Identifier n, std::shared_ptr<zir::Type> t)
+      : Symbol(n, std::move(t)) {}
   SymbolKind getKind() const noexcept override { return SymbolKind::Type; }
 };
 
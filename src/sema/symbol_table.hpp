@@ -1,41 +1,125 @@
 #pragma once
 #include "symbol.hpp"
-#include <map>
+#include "../utils/identifier.hpp"
+#include <cassert>
+#include <cstdint>
 #include <memory>
-#include <string>
 #include <vector>
 
 namespace sema {
 
+/// @brief All scopes that are alive at once in a single table: an open
+/// addressing hash table maps every name to its innermost declaration, and
+/// an undo log brings back the declarations a scope shadowed when it's
+/// popped. Lookups are a single probe sequence however deep the scopes are
+/// nested, and pushing or popping a scope allocates nothing.
 class SymbolTable {
 public:
-  SymbolTable(std::shared_ptr<SymbolTable> parent = nullptr)
-      : parent_(std::move(parent)) {}
+  SymbolTable() { rehash(MIN_CAPACITY); }
 
-  bool declare(const std::string &name, std::shared_ptr<Symbol> symbol) {
-    if (symbols_.find(name) != symbols_.end()) {
-      return false; // Already declared in this scope
+  /// @brief Declares name in the innermost scope.
+  /// @return False if it's already declared in that scope.
+  bool declare(zap::Identifier name, std::shared_ptr<Symbol> symbol) {
+    assert(!name.empty() && "declaring the empty name");
+    if ((used_ + 1) * 4 > slots_.size() * 3) {
+      rehash(slots_.size() * 2);
     }
-    symbols_[name] = std::move(symbol);
+
+    Slot &slot = slots_[probe(name)];
+    if (slot.name.empty()) {
+      slot.name = name;
+      ++used_;
+    } else if (slot.symbol && slot.depth == depth()) {
+      return false;
+    }
+
+    // Declarations of the global scope are never popped.
+    if (depth() > 0) {
+      undo_.push_back({name, slot.depth, std::move(slot.symbol)});
+    }
+    slot.symbol = std::move(symbol);
+    slot.depth = depth();
     return true;
   }
 
-  std::shared_ptr<Symbol> lookup(const std::string &name) const {
-    auto it = symbols_.find(name);
-    if (it != symbols_.end()) {
-      return it->second;
-    }
-    if (parent_) {
-      return parent_->lookup(name);
+  /// @brief Returns the innermost declaration of name, null if there is
+  /// none.
+  std::shared_ptr<Symbol> lookup(zap::Identifier name) const {
+    return slots_[probe(name)].symbol;
+  }
+
+  /// @brief Opens a scope, declarations shadow the ones of outer scopes
+  /// until it's popped.
+  void pushScope() { scopes_.push_back(undo_.size()); }
+
+  /// @brief Forgets the declarations of the innermost scope.
+  void popScope() {
+    assert(!scopes_.empty() && "popping the global scope");
+    size_t start = scopes_.back();
+    scopes_.pop_back();
+
+    while (undo_.size() > start) {
+      Undo &undo = undo_.back();
+      Slot &slot = slots_[probe(undo.name)];
+      slot.symbol = std::move(undo.symbol);
+      slot.depth = undo.depth;
+      undo_.pop_back();
     }
-    return nullptr;
   }
 
-  std::shared_ptr<SymbolTable> getParent() const { return parent_; }
+  /// @brief Returns how many scopes are pushed, 0 in the global scope.
+  uint32_t depth() const noexcept {
+    return static_cast<uint32_t>(scopes_.size());
+  }
 
 private:
-  std::shared_ptr<SymbolTable> parent_;
-  std::map<std::string, std::shared_ptr<Symbol>> symbols_;
+  static constexpr size_t MIN_CAPACITY = 64;
+
+  /// @brief A name that has been declared at least once. Slots are never
+  /// freed, popping the scope of a name only clears its symbol.
+  struct Slot {
+    zap::Identifier name;
+    uint32_t depth = 0; ///< Scope of symbol.
+    std::shared_ptr<Symbol> symbol;
+  };
+
+  /// @brief What a declaration replaced.
+  struct Undo {
+    zap::Identifier name;
+    uint32_t depth;
+    std::shared_ptr<Symbol> symbol;
+  };
+
+  std::vector<Slot> slots_; ///< Power of two sized.
+  std::vector<Undo> undo_;
+  std::vector<size_t> scopes_; ///< Where the undo log of every scope starts.
+  size_t used_ = 0;
+  unsigned shift_ = 0;
+
+  /// @brief Returns the slot of name, or the empty slot it would go in.
+  size_t probe(zap::Identifier name) const {
+    // Fibonacci hashing spreads the sequential IDs over the table.
+    size_t mask = slots_.size() - 1;
+    size_t index = (uint64_t(name.id()) * 0x9E3779B97F4A7C15ull) >> shift_;
+    while (!slots_[index].name.empty() && slots_[index].name != name) {
+      index = (index + 1) & mask;
+    }
+    return index;
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(slots_);
+    shift_ = 64;
+    for (size_t size = capacity; size > 1; size >>= 1) {
+      --shift_;
+    }
+    for (Slot &slot : old) {
+      if (!slot.name.empty()) {
+        slots_[probe(slot.name)] = std::move(slot);
+      }
+    }
+  }
 };
 
 } // namespace sema
@@ -1,5 +1,9 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include "../utils/identifier.hpp"
 
 /// @brief Determines the type the token will have.
 enum TokenType {
@@ -70,20 +74,20 @@ enum TokenType {
   CONST,
 };
 
-/// @brief Contains in-file related information like line, column, offset, and length.
+/// @brief Location of a piece of source as an offset and length into its
+/// file, 8 bytes per span. Lines and columns aren't stored, they are only
+/// computed from the offset (see 'zap::LineTable') when a diagnostic needs
+/// them. The file is implied by whoever owns the span (one file per
+/// lexer, parser and 'DiagnosticEngine').
 struct SourceSpan {
-  size_t line; ///< Line of the source in the file.
-  size_t column; ///< Column of the source in the file.
-  size_t offset; ///< Offset of the source in the file.
-  size_t length; ///< Length of the source.
+  uint32_t offset; ///< Offset of the source in the file.
+  uint32_t length; ///< Length of the source.
 
   /// @brief Basic constructor of the source span.
-  /// @param l Line.
-  /// @param c Column.
   /// @param o Offset.
   /// @param len Length.
-  SourceSpan(size_t l = 0, size_t c = 0, size_t o = 0, size_t len = 0) noexcept
-      : line(l), column(c), offset(o), length(len) {}
+  constexpr SourceSpan(size_t o = 0, size_t len = 0) noexcept
+      : offset(static_cast<uint32_t>(o)), length(static_cast<uint32_t>(len)) {}
 
   /// @brief Merges two 'SourceSpan' classes.
   /// @param start From.
@@ -92,24 +96,41 @@ struct SourceSpan {
   static SourceSpan merge(const SourceSpan &start, const SourceSpan &end) noexcept 
   {
     size_t newLen = (end.offset + end.length) - start.offset;
-    return SourceSpan(start.line, start.column, start.offset, newLen);
+    return SourceSpan(start.offset, newLen);
   }
 };
 
+static_assert(sizeof(SourceSpan) == 8, "SourceSpan should stay compact");
+
+/// @brief A token of the source. Doesn't own its text, it points into the
+/// source buffer (or a string literal for punctuation), which has to outlive
+/// the token.
 class Token {
 public:
   SourceSpan span; ///< Source of the token in the file.
   TokenType type; ///< Type of the token.
-  std::string value; ///< String of the token.
+  /// @brief Interned text of identifiers, empty for other tokens.
+  zap::Identifier ident;
+  /// @brief Text of the token. String and char literals hold the raw text
+  /// between the quotes, escape sequences aren't processed yet.
+  std::string_view value;
+  /// @brief Value of number literals, parsed once by the lexer.
+  union {
+    uint64_t integer = 0; ///< Value of integer literals, never negative.
+    double real; ///< Value of float literals.
+  };
+
+  /// @brief Empty token, e.g. to be filled by 'Lexer::next'.
+  Token() noexcept : type(), value() {}
 
   /// @brief Default constructor of the 'Token' class.
-  Token(TokenType type, const std::string &value, SourceSpan span)
+  Token(TokenType type, std::string_view value, SourceSpan span) noexcept
       : span(span), type(type), value(value) {}
 
   /// @brief Helper constructor for when we build span component-wise.
-  Token(TokenType type, const std::string &value, size_t line, size_t column,
-        size_t offset, size_t length)
-      : span(line, column, offset, length), type(type), value(value) {}
+  Token(TokenType type, std::string_view value, size_t offset,
+        size_t length) noexcept
+      : span(offset, length), type(type), value(value) {}
 
   ~Token() noexcept = default;
 };
@@ -0,0 +1,44 @@
+#include "arena.hpp"
+#include <algorithm>
+
+namespace zap {
+
+Arena::~Arena() {
+  for (Cleanup *cleanup = cleanups; cleanup; cleanup = cleanup->next) {
+    cleanup->destroy(cleanup->object);
+  }
+  while (blocks) {
+    Block *next = blocks->next;
+    ::operator delete(blocks);
+    blocks = next;
+  }
+}
+
+void *Arena::allocateSlow(size_t size, size_t align) {
+  size_t needed = sizeof(Block) + size + align;
+  bool dedicated = needed > BLOCK_SIZE / 2;
+  size_t blockSize = std::max(needed, BLOCK_SIZE);
+
+  Block *block = static_cast<Block *>(::operator new(blockSize));
+  block->next = blocks;
+  blocks = block;
+  reserved += blockSize;
+
+  uintptr_t first = reinterpret_cast<uintptr_t>(block + 1);
+  uintptr_t start = (first + align - 1) & ~(uintptr_t)(align - 1);
+  if (!dedicated) {
+    // Big allocations don't replace the current block, it may still have
+    // plenty of room.
+    cur = start + size;
+    end = reinterpret_cast<uintptr_t>(block) + blockSize;
+  }
+  return reinterpret_cast<void *>(start);
+}
+
+void Arena::addCleanup(void *object, void (*destroy)(void *)) {
+  // New cleanups go first, so objects are destroyed in reverse order.
+  cleanups = new (allocate(sizeof(Cleanup), alignof(Cleanup)))
+      Cleanup{destroy, object, cleanups};
+}
+
+} // namespace zap
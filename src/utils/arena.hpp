@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace zap {
+
+/// @brief A fixed size array allocated in an arena. It doesn't own its
+/// elements, the arena does.
+template <typename T> class ArenaList {
+public:
+  constexpr ArenaList() noexcept = default;
+  constexpr ArenaList(T *items, size_t count) noexcept
+      : items(items), count(count) {}
+
+  T *begin() const noexcept { return items; }
+  T *end() const noexcept { return items + count; }
+  T &operator[](size_t index) const noexcept { return items[index]; }
+  size_t size() const noexcept { return count; }
+  bool empty() const noexcept { return count == 0; }
+
+private:
+  T *items = nullptr;
+  size_t count = 0;
+};
+
+/// @brief A bump allocator: objects are carved out of big blocks and all
+/// freed at once when the arena is destroyed.
+///
+/// Objects with a non-trivial destructor get it called then, in reverse
+/// order of creation, trivially destructible ones cost nothing to free.
+class Arena {
+public:
+  /// @brief Size of the blocks, bigger allocations get a block of their own.
+  constexpr static size_t BLOCK_SIZE = 0x10000;
+
+  Arena() noexcept = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  ~Arena();
+
+  /// @brief Allocates uninitialized memory.
+  /// @param align A power of two.
+  void *allocate(size_t size, size_t align) {
+    uintptr_t start = (cur + align - 1) & ~(uintptr_t)(align - 1);
+    if (start > end || size > end - start) {
+      return allocateSlow(size, align);
+    }
+    cur = start + size;
+    return reinterpret_cast<void *>(start);
+  }
+
+  /// @brief Constructs an object that lives as long as the arena.
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *object = new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      addCleanup(object, [](void *ptr) { static_cast<T *>(ptr)->~T(); });
+    }
+    return object;
+  }
+
+  /// @brief Copies items into the arena.
+  template <typename T> ArenaList<T> makeList(const std::vector<T> &items) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena lists never destroy their elements");
+    if (items.empty()) {
+      return {};
+    }
+    T *copy = static_cast<T *>(allocate(sizeof(T) * items.size(), alignof(T)));
+    std::uninitialized_copy(items.begin(), items.end(), copy);
+    return ArenaList<T>(copy, items.size());
+  }
+
+  /// @brief Returns how many bytes the blocks take.
+  size_t bytesReserved() const noexcept { return reserved; }
+
+private:
+  struct Block {
+    Block *next;
+  };
+
+  struct Cleanup {
+    void (*destroy)(void *);
+    void *object;
+    Cleanup *next;
+  };
+
+  uintptr_t cur = 0, end = 0;
+  Block *blocks = nullptr;
+  Cleanup *cleanups = nullptr;
+  size_t reserved = 0;
+
+  void *allocateSlow(size_t size, size_t align);
+  void addCleanup(void *object, void (*destroy)(void *));
+};
+
+} // namespace zap
@@ -1,8 +1,9 @@
 #pragma once
-#include <iostream>
 #include <string>
 #include <vector>
 #include "../token/token.hpp"
+#include "line_table.hpp"
+#include "stream.hpp"
 
 namespace zap {
 
@@ -14,13 +15,20 @@ enum class DiagnosticLevel {
 
 class DiagnosticEngine {
 private:
-  const std::string& source;
+  LineTable lines;
   std::string fileName;
+  Stream& out;
   size_t errorCount = 0;
 
 public:
-  DiagnosticEngine(const std::string& src, const std::string& fname = "input") 
-    : source(src), fileName(fname) {}
+  DiagnosticEngine(const std::string& src, const std::string& fname = "input",
+                   Stream& os = err())
+    : lines(src), fileName(fname), out(os) {}
+
+  /// @brief An engine for the same file that writes to os instead, so
+  /// diagnostics of other threads can be buffered and passed to append().
+  DiagnosticEngine(const DiagnosticEngine& other, Stream& os)
+    : lines(other.lines), fileName(other.fileName), out(os) {}
 
   void report(SourceSpan span, DiagnosticLevel level, const std::string& message) {
     if (level == DiagnosticLevel::Error) {
@@ -34,48 +42,44 @@ public:
       case DiagnosticLevel::Error: levelStr = "\033[1;31merror\033[0m"; break;
     }
 
-    std::cerr << levelStr << ": " << message << std::endl;
-    std::cerr << " --> " << fileName << ":" << span.line << ":" << span.column << std::endl;
+    LineColumn pos = lines.lookup(span.offset);
+    out << levelStr << ": " << message << '\n';
+    out << " --> " << fileName << ":" << pos.line << ":" << pos.column << '\n';
 
-    printContext(span);
+    printContext(span, pos);
   }
 
   bool hadErrors() const {
     return errorCount > 0;
   }
 
-private:
-  void printContext(SourceSpan span) {
-    size_t lineStart = 0;
-    size_t line = 1;
-    size_t i = 0;
-    while (i < source.length() && line < span.line) {
-      if (source[i] == '\n') {
-        line++;
-        lineStart = i + 1;
-      }
-      i++;
-    }
-    
-    size_t lineEnd = lineStart;
-    while (lineEnd < source.length() && source[lineEnd] != '\n') {
-      lineEnd++;
-    }
+  size_t errors() const {
+    return errorCount;
+  }
 
-    std::string lineContent = source.substr(lineStart, lineEnd - lineStart);
+  /// @brief Writes out diagnostics buffered by another engine of this file.
+  /// @param errors How many errors the text contains.
+  void append(const std::string& text, size_t errors) {
+    out << text;
+    errorCount += errors;
+  }
+
+private:
+  void printContext(SourceSpan span, LineColumn pos) {
+    std::string_view lineContent = lines.lineText(pos.line);
     
-    std::string lineNumStr = std::to_string(span.line);
-    std::cerr << " " << lineNumStr << " | " << lineContent << "\n";
+    std::string lineNumStr = std::to_string(pos.line);
+    out << " " << lineNumStr << " | " << lineContent << "\n";
     
     size_t prefixLen = lineNumStr.length() + 4; 
-    for (size_t j = 0; j < prefixLen; ++j) std::cerr << " ";
+    for (size_t j = 0; j < prefixLen; ++j) out << " ";
 
-    size_t startIdx = span.column > 0 ? span.column - 1 : 0;
+    size_t startIdx = pos.column - 1;
     for (size_t j = 0; j < startIdx; ++j) {
-      std::cerr << " ";
+      out << " ";
     }
 
-    std::cerr << "\033[1;31m";
+    out << "\033[1;31m";
     size_t len = span.length > 0 ? span.length : 1;
 
     if (startIdx >= lineContent.size()) {
@@ -88,15 +92,15 @@ private:
     const size_t MAX_UNDERLINE = 40;
     if (len > MAX_UNDERLINE) {
       size_t half = MAX_UNDERLINE / 2;
-      for (size_t i = 0; i < half; ++i) std::cerr << "^";
-      std::cerr << "...";
-      for (size_t i = 0; i < half; ++i) std::cerr << "^";
+      for (size_t i = 0; i < half; ++i) out << "^";
+      out << "...";
+      for (size_t i = 0; i < half; ++i) out << "^";
     } else {
       for (size_t j = 0; j < len; ++j) {
-        std::cerr << "^";
+        out << "^";
       }
     }
-    std::cerr << "\033[0m" << std::endl;
+    out << "\033[0m" << '\n';
   }
 };
 
@@ -0,0 +1,89 @@
+#include "identifier.hpp"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace zap {
+
+namespace {
+
+// The strings are stored in fixed size chunks that never move, so reading
+// an identifier needs no lock and the map keys can point into them.
+constexpr uint32_t CHUNK_BITS = 12;
+constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+constexpr uint32_t MAX_CHUNKS = 1u << 12;
+
+class IdentifierTable {
+public:
+  IdentifierTable() { intern(""); }
+
+  uint32_t intern(std::string_view text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(text);
+    if (it != ids.end()) {
+      return it->second;
+    }
+
+    uint32_t id = count;
+    if (id >> CHUNK_BITS >= MAX_CHUNKS) {
+      throw std::length_error("too many identifiers");
+    }
+
+    std::string *chunk =
+        chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+    if (!chunk) {
+      chunk = new std::string[CHUNK_SIZE];
+      chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+    }
+
+    std::string &slot = chunk[id & (CHUNK_SIZE - 1)];
+    slot.assign(text);
+    ids.emplace(slot, id);
+    ++count;
+    return id;
+  }
+
+  const std::string &get(uint32_t id) const noexcept {
+    const std::string *chunk =
+        chunks[id >> CHUNK_BITS].load(std::memory_order_acquire);
+    return chunk[id & (CHUNK_SIZE - 1)];
+  }
+
+private:
+  std::mutex mutex;
+  std::unordered_map<std::string_view, uint32_t> ids;
+  std::array<std::atomic<std::string *>, MAX_CHUNKS> chunks{};
+  uint32_t count = 0;
+};
+
+/// @brief Never destroyed, identifiers may outlive static destructors.
+IdentifierTable &table() {
+  static IdentifierTable *instance = new IdentifierTable();
+  return *instance;
+}
+
+} // namespace
+
+Identifier::Identifier(std::string_view text) {
+  // Most names repeat within a file, so every thread remembers the ones it
+  // has seen and only takes the table's lock for new ones.
+  thread_local std::unordered_map<std::string_view, uint32_t> cache;
+
+  auto it = cache.find(text);
+  if (it != cache.end()) {
+    id_ = it->second;
+    return;
+  }
+
+  IdentifierTable &ids = table();
+  id_ = ids.intern(text);
+  cache.emplace(ids.get(id_), id_);
+}
+
+const std::string &Identifier::str() const noexcept {
+  return table().get(id_);
+}
+
+} // namespace zap
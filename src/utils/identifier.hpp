@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace zap {
+
+/// @brief An interned name: a 32-bit ID into a process wide string table.
+/// Equal names always get the same ID, so comparing and hashing
+/// identifiers never touches their text. Interning is thread-safe and the
+/// text lives until the process exits.
+class Identifier {
+public:
+  /// @brief The empty identifier.
+  constexpr Identifier() noexcept : id_(0) {}
+
+  /// @brief Interns text.
+  Identifier(std::string_view text);
+  Identifier(const std::string &text) : Identifier(std::string_view(text)) {}
+  Identifier(const char *text) : Identifier(std::string_view(text)) {}
+
+  /// @brief Returns the interned text.
+  const std::string &str() const noexcept;
+  operator const std::string &() const noexcept { return str(); }
+
+  uint32_t id() const noexcept { return id_; }
+  bool empty() const noexcept { return id_ == 0; }
+
+  friend bool operator==(Identifier a, Identifier b) noexcept {
+    return a.id_ == b.id_;
+  }
+  friend bool operator!=(Identifier a, Identifier b) noexcept {
+    return a.id_ != b.id_;
+  }
+
+  // Names are mostly concatenated into messages and mangled names.
+  friend std::string operator+(const std::string &lhs, Identifier rhs) {
+    return lhs + rhs.str();
+  }
+  friend std::string operator+(Identifier lhs, const std::string &rhs) {
+    return lhs.str() + rhs;
+  }
+  friend std::string operator+(const char *lhs, Identifier rhs) {
+    return lhs + rhs.str();
+  }
+  friend std::string operator+(Identifier lhs, const char *rhs) {
+    return lhs.str() + rhs;
+  }
+  friend std::ostream &operator<<(std::ostream &os, Identifier ident) {
+    return os << ident.str();
+  }
+
+private:
+  uint32_t id_;
+};
+
+} // namespace zap
+
+namespace std {
+
+template <> struct hash<zap::Identifier> {
+  size_t operator()(zap::Identifier ident) const noexcept {
+    return ident.id();
+  }
+};
+
+} // namespace std
@@ -0,0 +1,65 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace zap {
+
+/// @brief 1-based line and column of an offset.
+struct LineColumn {
+  uint32_t line;
+  uint32_t column;
+};
+
+/// @brief Turns file offsets into lines and columns. The start of every
+/// line is only collected on the first lookup, so files without
+/// diagnostics never pay for it.
+class LineTable {
+private:
+  std::string_view source;
+  std::vector<uint32_t> lineStarts;
+
+  void build() {
+    lineStarts.push_back(0);
+    for (size_t i = 0; i < source.size(); ++i) {
+      if (source[i] == '\n') {
+        lineStarts.push_back(static_cast<uint32_t>(i + 1));
+      }
+    }
+  }
+
+public:
+  /// @brief The source has to outlive the table.
+  explicit LineTable(std::string_view src) noexcept : source(src) {}
+
+  /// @brief Returns the line and column of an offset.
+  LineColumn lookup(uint32_t offset) {
+    if (lineStarts.empty()) {
+      build();
+    }
+
+    // The last line starting at or before the offset.
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    size_t line = static_cast<size_t>(it - lineStarts.begin());
+    uint32_t column = offset - lineStarts[line - 1] + 1;
+    return {static_cast<uint32_t>(line), column};
+  }
+
+  /// @brief Returns the text of a 1-based line, without its line break.
+  std::string_view lineText(uint32_t line) {
+    if (lineStarts.empty()) {
+      build();
+    }
+    if (line == 0 || line > lineStarts.size()) {
+      return {};
+    }
+
+    size_t start = lineStarts[line - 1];
+    size_t end = line < lineStarts.size() ? lineStarts[line] - 1
+                                          : source.size();
+    return source.substr(start, end - start);
+  }
+};
+
+} // namespace zap
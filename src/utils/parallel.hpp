@@ -0,0 +1,24 @@
+#pragma once
+#include <thread>
+#include <vector>
+
+namespace zap {
+
+/// @brief Calls work on threads threads at once, the calling thread being one
+/// of them, and returns when all of them have returned. Work usually pulls
+/// indices from a shared atomic counter until there are none left.
+template <typename Work> void runOnThreads(unsigned threads, const Work &work) {
+  std::vector<std::thread> pool;
+  if (threads > 1) {
+    pool.reserve(threads - 1);
+  }
+  for (unsigned i = 1; i < threads; ++i) {
+    pool.emplace_back([&work] { work(); });
+  }
+  work();
+  for (std::thread &t : pool) {
+    t.join();
+  }
+}
+
+} // namespace zap
@@ -191,6 +191,27 @@ public:
   }
 };
 
+/// @brief Stream that appends everything written to it to a string, used to
+/// buffer output that has to be printed later.
+class StringStream : public Stream {
+  std::string &str;
+  bool colors;
+
+  void internalWrite(const BufferChar *ptr, size_t size) override {
+    str.append(ptr, size);
+  }
+
+public:
+  /// @brief Opens a new stream to a string.
+  /// @param s String to append to.
+  /// @param useColors Whether color codes should be written, usually the
+  /// value of hasColors() of the stream the string ends up in.
+  StringStream(std::string &s, bool useColors = false)
+      : Stream(0), str(s), colors(useColors) {}
+
+  bool hasColors() const override { return colors; }
+};
+
 extern Stream &err();
 extern Stream &out();
 